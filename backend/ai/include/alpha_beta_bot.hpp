@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "bot.hpp"
+#include "game.hpp"
+
+namespace spread_ai {
+
+namespace detail {
+class TranspositionTable;
+}  // namespace detail
+
+struct AlphaBetaOptions {
+  // Iterative deepening stops at whichever limit comes first, 0 disables a
+  // limit. The first iteration always completes, so a move is always found.
+  std::chrono::milliseconds time_budget{1000};
+  std::size_t max_depth{0};
+  // Search threads sharing the transposition table, 0 uses every hardware
+  // thread
+  std::size_t thread_count{1};
+  std::size_t table_size_mb{64};
+};
+
+struct AlphaBetaResult {
+  std::size_t cell_idx;
+  // From the point of view of the searching player, kWinScore minus the plies
+  // to a forced win
+  int score;
+  std::size_t depth;  // last completed iteration
+  std::uint64_t nodes;
+};
+
+// Deterministic searcher: iterative-deepening alpha-beta with the paranoid
+// reduction for more than two players, where every opponent minimizes the
+// score of the searching player. For two players it is plain alpha-beta.
+//
+// Moves are ordered by the transposition table move, then by the history
+// heuristic. Extra threads run Lazy SMP: they search the same root at
+// staggered depths and only share the lock-free transposition table, the
+// result comes from the main thread. With one thread and a depth limit the
+// search is fully reproducible, which makes max_depth a difficulty level.
+//
+// Plays any game type of spread_logic::AnyGame; AlphaBetaBot plays Game.
+template <class GameType>
+class BasicAlphaBetaBot : public spread_logic::BasicMoveSource<GameType> {
+ public:
+  constexpr static int kWinScore = 30000;
+
+  // Throws errors::kNoSearchBudget if neither limit is set
+  explicit BasicAlphaBetaBot(AlphaBetaOptions options = {});
+  ~BasicAlphaBetaBot() override;
+
+  AlphaBetaResult Search(const GameType& game);
+
+  std::size_t ChooseMove(const GameType& game) override;
+
+ private:
+  AlphaBetaOptions options_;
+  // Kept between searches, so later moves reuse earlier work
+  std::unique_ptr<detail::TranspositionTable> table_;
+};
+
+using AlphaBetaBot = BasicAlphaBetaBot<spread_logic::Game>;
+
+// Defined in alpha_beta_bot.cpp for every alternative of spread_logic::AnyGame
+extern template class BasicAlphaBetaBot<spread_logic::Game>;
+#define SPREAD_AI_EXTERN_FIXED_ALPHA_BETA_BOT(width, height) \
+  extern template class BasicAlphaBetaBot<                   \
+      spread_logic::FixedGame<width, height>>;
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_AI_EXTERN_FIXED_ALPHA_BETA_BOT)
+#undef SPREAD_AI_EXTERN_FIXED_ALPHA_BETA_BOT
+#define SPREAD_AI_EXTERN_VARIANT_ALPHA_BETA_BOT(capture, dots) \
+  extern template class BasicAlphaBetaBot<                     \
+      spread_logic::VariantGame<capture, dots>>;
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_AI_EXTERN_VARIANT_ALPHA_BETA_BOT)
+#undef SPREAD_AI_EXTERN_VARIANT_ALPHA_BETA_BOT
+
+}  // namespace spread_ai
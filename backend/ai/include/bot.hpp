@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "game.hpp"
+
+namespace spread_ai {
+
+namespace errors {
+const std::logic_error kNoLegalMoves{"Active player has no legal move"};
+const std::logic_error kNoSearchBudget{
+    "Search needs a time budget or a search limit"};
+}  // namespace errors
+
+// Cells the active player may place a dot on, in index order
+template <class GameType>
+void CollectLegalMoves(const GameType& game,
+                       std::vector<std::uint32_t>& moves) {
+  moves.clear();
+  for (auto cell : game.GetLegalMoves()) {
+    moves.push_back(static_cast<std::uint32_t>(cell));
+  }
+}
+
+}  // namespace spread_ai
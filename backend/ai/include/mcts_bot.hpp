@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "bot.hpp"
+#include "game.hpp"
+
+namespace spread_ai {
+
+struct MctsOptions {
+  // Search stops at whichever budget runs out first, 0 disables a budget
+  std::chrono::milliseconds time_budget{1000};
+  std::size_t playout_budget{0};
+  // Worker threads, 0 uses every hardware thread
+  std::size_t thread_count{0};
+  // Random playouts stop after this many moves per cell and are scored by
+  // dots, 0 plays them out to the end
+  std::size_t playout_moves_per_cell{4};
+  // UCT exploration constant
+  double exploration{1.4};
+  std::uint64_t seed{0};
+};
+
+// Root move statistics summed over all workers
+struct MoveVisitStats {
+  std::size_t cell_idx;
+  std::uint64_t visits;
+  double reward;  // sum of rewards in [0, 1] for the player making the move
+};
+
+struct SearchResult {
+  std::size_t cell_idx;
+  std::uint64_t playouts;
+  std::vector<MoveVisitStats> moves;  // ordered by cell index
+};
+
+// Monte Carlo Tree Search with UCT selection and random playouts.
+//
+// Root-parallel: every worker grows its own tree from the root position with
+// its own random stream, and the root statistics are summed at the end. The
+// workers share nothing while searching, so they scale with the cores. Each
+// worker replays its iterations on one scratch copy of the game that is
+// reassigned from the root, which reuses its buffers.
+//
+// Rewards are per player: a playout that ends the game gives 1 to the
+// winner, a cut playout gives 1 to the players with the most dots, split
+// between ties. Every node keeps the reward of the player who moved into it
+// (max^n), so the bot works for any number of players.
+//
+// Plays any game type of spread_logic::AnyGame; MctsBot plays Game.
+template <class GameType>
+class BasicMctsBot : public spread_logic::BasicMoveSource<GameType> {
+ public:
+  // Throws errors::kNoSearchBudget if neither budget is set
+  explicit BasicMctsBot(MctsOptions options = {});
+
+  // Search the position of the active player. With a fixed seed and only a
+  // playout budget the bot makes the same moves every time it plays a game.
+  SearchResult Search(const GameType& game);
+
+  std::size_t ChooseMove(const GameType& game) override;
+
+ private:
+  MctsOptions options_;
+  // Advanced every search so consecutive moves see different playouts
+  std::uint64_t search_count_{0};
+};
+
+using MctsBot = BasicMctsBot<spread_logic::Game>;
+
+// Defined in mcts_bot.cpp for every alternative of spread_logic::AnyGame
+extern template class BasicMctsBot<spread_logic::Game>;
+#define SPREAD_AI_EXTERN_FIXED_MCTS_BOT(width, height) \
+  extern template class BasicMctsBot<spread_logic::FixedGame<width, height>>;
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_AI_EXTERN_FIXED_MCTS_BOT)
+#undef SPREAD_AI_EXTERN_FIXED_MCTS_BOT
+#define SPREAD_AI_EXTERN_VARIANT_MCTS_BOT(capture, dots) \
+  extern template class BasicMctsBot<spread_logic::VariantGame<capture, dots>>;
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_AI_EXTERN_VARIANT_MCTS_BOT)
+#undef SPREAD_AI_EXTERN_VARIANT_MCTS_BOT
+
+}  // namespace spread_ai
@@ -0,0 +1,386 @@
+#include "alpha_beta_bot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "transposition_table.hpp"
+
+namespace spread_ai {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Bound = detail::TranspositionTable::Bound;
+
+constexpr int kInfinity = 32000;
+// Heuristic scores stay clear of the win scores
+constexpr int kMaxEval = 20000;
+// Depth is stored in a byte; also the farthest ply a win score can encode
+constexpr int kMaxDepth = 250;
+constexpr int kWinThreshold = AlphaBetaBot::kWinScore - kMaxDepth;
+constexpr std::uint32_t kNoMove = UINT32_MAX;
+
+// Win scores count plies from the root; the table stores them relative to the
+// node so they stay valid wherever the position comes up again
+int ToTable(int score, int ply) {
+  if (score >= kWinThreshold) {
+    return score + ply;
+  }
+  if (score <= -kWinThreshold) {
+    return score - ply;
+  }
+  return score;
+}
+
+int FromTable(int score, int ply) {
+  if (score >= kWinThreshold) {
+    return score - ply;
+  }
+  if (score <= -kWinThreshold) {
+    return score + ply;
+  }
+  return score;
+}
+
+struct SharedState {
+  detail::TranspositionTable& table;
+  Clock::time_point deadline;
+  bool timed;
+  std::atomic<bool> stop{false};
+};
+
+// One search thread with its own copy of the game
+template <class GameType>
+class Searcher {
+ public:
+  Searcher(SharedState& shared, const GameType& root)
+      : shared_(shared),
+        game_(root),
+        root_player_(root.GetCurrentPlayer()),
+        // Paranoid scores belong to the root player, so are the table entries
+        key_salt_(0x9E3779B97F4A7C15ULL * (root_player_ + 1)),
+        history_(root.GetField().GetCellCount(), 0),
+        moves_(kMaxDepth + 1) {
+    CollectLegalMoves(game_, root_moves_);
+  }
+
+  // Iterative deepening from first_depth until max_depth (0 for none), the
+  // deadline or the stop flag. The main searcher raises the stop flag when it
+  // is done, which ends the helpers.
+  void Run(int first_depth, int max_depth, bool main) {
+    main_ = main;
+    if (max_depth == 0 || max_depth > kMaxDepth) {
+      max_depth = kMaxDepth;
+    }
+    for (auto depth = first_depth; depth <= max_depth; ++depth) {
+      depth_limited_ = false;
+      auto score = SearchRoot(depth);
+      if (aborted_) {
+        break;
+      }
+      completed_depth_ = depth;
+      best_score_ = score;
+      // Nothing changes at larger depths once the tree is solved
+      if (!depth_limited_ || score >= kWinThreshold ||
+          score <= -kWinThreshold) {
+        break;
+      }
+    }
+    if (main_) {
+      shared_.stop = true;
+    }
+  }
+
+  std::uint32_t GetBestMove() const {
+    return root_moves_.front();
+  }
+  int GetBestScore() const {
+    return best_score_;
+  }
+  int GetCompletedDepth() const {
+    return completed_depth_;
+  }
+  std::uint64_t GetNodes() const {
+    return nodes_;
+  }
+
+ private:
+  bool IsOver() const {
+    auto alive = game_.GetAlivePlayers();
+    return alive.size() <= 1 || !alive.Contains(root_player_);
+  }
+
+  void CheckTime() {
+    if (shared_.stop) {
+      aborted_ = true;
+    } else if (shared_.timed && (!main_ || completed_depth_ > 0) &&
+               Clock::now() >= shared_.deadline) {
+      aborted_ = true;
+      if (main_) {
+        shared_.stop = true;
+      }
+    }
+  }
+
+  // Score of the position for the root player
+  int Evaluate(int ply) const {
+    auto alive = game_.GetAlivePlayers();
+    if (!alive.Contains(root_player_)) {
+      return -AlphaBetaBot::kWinScore + ply;
+    }
+    if (alive.size() == 1) {
+      return AlphaBetaBot::kWinScore - ply;
+    }
+    // Material: dots plus cells, against the strongest opponent
+    const auto& scores = game_.GetField().GetPlayerScores();
+    const auto& owned = game_.GetField().GetOwnedCells();
+    auto material = [&](std::size_t player_index) {
+      return static_cast<std::int64_t>(scores[player_index]) +
+             owned[player_index];
+    };
+    std::int64_t strongest = 0;
+    for (auto player_index : alive) {
+      if (player_index != root_player_) {
+        strongest = std::max(strongest, material(player_index));
+      }
+    }
+    return static_cast<int>(std::clamp<std::int64_t>(
+        material(root_player_) - strongest, -kMaxEval, kMaxEval));
+  }
+
+  void OrderMoves(std::vector<std::uint32_t>& moves, std::uint32_t tt_move) {
+    std::sort(moves.begin(), moves.end(),
+              [this, tt_move](std::uint32_t a, std::uint32_t b) {
+                if ((a == tt_move) != (b == tt_move)) {
+                  return a == tt_move;
+                }
+                if (history_[a] != history_[b]) {
+                  return history_[a] > history_[b];
+                }
+                return a < b;
+              });
+  }
+
+  int SearchRoot(int depth) {
+    auto alpha = -kInfinity;
+    auto best_score = -kInfinity;
+    std::size_t best = 0;
+    for (std::size_t i = 0; i < root_moves_.size(); ++i) {
+      game_.Apply(root_moves_[i]);
+      auto score = Search(depth - 1, alpha, kInfinity, 1);
+      game_.Undo();
+      if (aborted_) {
+        return 0;
+      }
+      if (score > best_score) {
+        best_score = score;
+        best = i;
+      }
+      alpha = std::max(alpha, score);
+    }
+    // The next iteration starts with the best move
+    std::rotate(root_moves_.begin(), root_moves_.begin() + best,
+                root_moves_.begin() + best + 1);
+    shared_.table.Store(game_.GetHash() ^ key_salt_,
+                        {root_moves_.front(),
+                         static_cast<std::int16_t>(ToTable(best_score, 0)),
+                         static_cast<std::uint8_t>(depth), Bound::kExact});
+    return best_score;
+  }
+
+  int Search(int depth, int alpha, int beta, int ply) {
+    if ((++nodes_ & 1023) == 0) {
+      CheckTime();
+    }
+    if (aborted_) {
+      return 0;
+    }
+    if (IsOver()) {
+      return Evaluate(ply);
+    }
+    if (depth == 0) {
+      depth_limited_ = true;
+      return Evaluate(ply);
+    }
+
+    auto key = game_.GetHash() ^ key_salt_;
+    auto tt_move = kNoMove;
+    detail::TranspositionTable::Entry entry;
+    if (shared_.table.Probe(key, entry)) {
+      tt_move = entry.move;
+      auto score = FromTable(entry.score, ply);
+      if (entry.depth >= depth &&
+          (entry.bound == Bound::kExact ||
+           (entry.bound == Bound::kLower && score >= beta) ||
+           (entry.bound == Bound::kUpper && score <= alpha))) {
+        // The stored subtree may have been cut at its depth
+        depth_limited_ = depth_limited_ || (score < kWinThreshold &&
+                                            score > -kWinThreshold);
+        return score;
+      }
+    }
+
+    auto& moves = moves_[ply];
+    CollectLegalMoves(game_, moves);
+    if (moves.empty()) {
+      depth_limited_ = true;
+      return Evaluate(ply);
+    }
+    OrderMoves(moves, tt_move);
+
+    // Paranoid: every opponent minimizes the score of the root player
+    bool maximizing = game_.GetCurrentPlayer() == root_player_;
+    auto original_alpha = alpha;
+    auto original_beta = beta;
+    auto best_score = maximizing ? -kInfinity : kInfinity;
+    auto best_move = moves.front();
+    for (auto move : moves) {
+      game_.Apply(move);
+      auto score = Search(depth - 1, alpha, beta, ply + 1);
+      game_.Undo();
+      if (aborted_) {
+        return 0;
+      }
+      if (maximizing ? score > best_score : score < best_score) {
+        best_score = score;
+        best_move = move;
+      }
+      if (maximizing) {
+        alpha = std::max(alpha, score);
+      } else {
+        beta = std::min(beta, score);
+      }
+      if (alpha >= beta) {
+        history_[move] += static_cast<std::uint32_t>(depth * depth);
+        break;
+      }
+    }
+
+    auto bound = Bound::kExact;
+    if (best_score <= original_alpha) {
+      bound = Bound::kUpper;
+    } else if (best_score >= original_beta) {
+      bound = Bound::kLower;
+    }
+    shared_.table.Store(
+        key, {best_move, static_cast<std::int16_t>(ToTable(best_score, ply)),
+              static_cast<std::uint8_t>(depth), bound});
+    return best_score;
+  }
+
+  SharedState& shared_;
+  GameType game_;
+  std::size_t root_player_;
+  std::uint64_t key_salt_;
+  bool main_{false};
+  bool aborted_{false};
+  // Set when an iteration cut the tree at its depth rather than at game ends
+  bool depth_limited_{false};
+  int completed_depth_{0};
+  int best_score_{0};
+  std::uint64_t nodes_{0};
+  // Ordered with the best move of the last iteration first
+  std::vector<std::uint32_t> root_moves_;
+  std::vector<std::uint32_t> history_;
+  // Move buffers per ply
+  std::vector<std::vector<std::uint32_t>> moves_;
+};
+
+}  // namespace
+
+template <class GameType>
+BasicAlphaBetaBot<GameType>::BasicAlphaBetaBot(AlphaBetaOptions options)
+    : options_(options),
+      table_(std::make_unique<detail::TranspositionTable>(
+          options.table_size_mb)) {
+  if (options_.time_budget.count() == 0 && options_.max_depth == 0) {
+    throw errors::kNoSearchBudget;
+  }
+}
+
+template <class GameType>
+BasicAlphaBetaBot<GameType>::~BasicAlphaBetaBot() = default;
+
+template <class GameType>
+AlphaBetaResult BasicAlphaBetaBot<GameType>::Search(const GameType& game) {
+  if (game.GetAlivePlayers().size() <= 1) {
+    throw spread_logic::errors::kGameAlreadyOver;
+  }
+  std::vector<std::uint32_t> legal;
+  CollectLegalMoves(game, legal);
+  if (legal.empty()) {
+    throw errors::kNoLegalMoves;
+  }
+  if (legal.size() == 1) {
+    return AlphaBetaResult{legal.front(), 0, 0, 0};
+  }
+
+  std::size_t thread_count = options_.thread_count;
+  if (thread_count == 0) {
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  }
+  table_->NewSearch();
+  SharedState shared{*table_, Clock::now() + options_.time_budget,
+                     options_.time_budget.count() != 0};
+  std::vector<std::unique_ptr<Searcher<GameType>>> searchers;
+  searchers.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    searchers.push_back(std::make_unique<Searcher<GameType>>(shared, game));
+  }
+
+  // Helpers start at alternating depths so they fill the table ahead of the
+  // main searcher instead of repeating it
+  auto max_depth = static_cast<int>(std::min<std::size_t>(
+      options_.max_depth, static_cast<std::size_t>(kMaxDepth)));
+  std::vector<std::exception_ptr> failures(thread_count);
+  auto run = [&](std::size_t i) {
+    try {
+      searchers[i]->Run(1 + static_cast<int>(i & 1), max_depth, i == 0);
+    } catch (...) {
+      failures[i] = std::current_exception();
+      shared.stop = true;
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (std::size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(run, i);
+  }
+  run(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& failure : failures) {
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+  }
+
+  const auto& main = *searchers.front();
+  AlphaBetaResult result{main.GetBestMove(), main.GetBestScore(),
+                         static_cast<std::size_t>(main.GetCompletedDepth()), 0};
+  for (const auto& searcher : searchers) {
+    result.nodes += searcher->GetNodes();
+  }
+  return result;
+}
+
+template <class GameType>
+std::size_t BasicAlphaBetaBot<GameType>::ChooseMove(const GameType& game) {
+  return Search(game).cell_idx;
+}
+
+template class BasicAlphaBetaBot<spread_logic::Game>;
+#define SPREAD_AI_INSTANTIATE_FIXED_ALPHA_BETA_BOT(width, height) \
+  template class BasicAlphaBetaBot<spread_logic::FixedGame<width, height>>;
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_AI_INSTANTIATE_FIXED_ALPHA_BETA_BOT)
+#undef SPREAD_AI_INSTANTIATE_FIXED_ALPHA_BETA_BOT
+#define SPREAD_AI_INSTANTIATE_VARIANT_ALPHA_BETA_BOT(capture, dots) \
+  template class BasicAlphaBetaBot<spread_logic::VariantGame<capture, dots>>;
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_AI_INSTANTIATE_VARIANT_ALPHA_BETA_BOT)
+#undef SPREAD_AI_INSTANTIATE_VARIANT_ALPHA_BETA_BOT
+
+}  // namespace spread_ai
@@ -0,0 +1,357 @@
+#include "mcts_bot.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <thread>
+
+namespace spread_ai {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// splitmix64, small and fast enough for playouts
+class Random {
+ public:
+  explicit Random(std::uint64_t seed)
+      : state_(seed) {
+  }
+
+  std::uint64_t Next() {
+    std::uint64_t x = (state_ += 0x9E3779B97F4A7C15ULL);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+  }
+
+  // Uniform in [0, bound), bound below 2^32
+  std::size_t Below(std::size_t bound) {
+    return static_cast<std::size_t>(((Next() >> 32) * bound) >> 32);
+  }
+
+ private:
+  std::uint64_t state_;
+};
+
+// One worker of the root-parallel search, owns its tree and scratch game
+template <class GameType>
+class TreeSearch {
+ public:
+  TreeSearch(const GameType& root, const MctsOptions& options,
+             std::uint64_t seed)
+      : root_(root),
+        options_(options),
+        random_(seed),
+        scratch_(root),
+        tried_(root.GetField().GetCellCount(), 0),
+        rewards_(root.GetField().GetPlayerScores().size(), 0.0) {
+    nodes_.push_back(Node{});
+  }
+
+  // Run iterations until the playout budget (0 for none) or the deadline
+  void Run(std::uint64_t playouts, Clock::time_point deadline) {
+    if (playouts != 0) {
+      nodes_.reserve(playouts + 1);
+    }
+    bool timed = options_.time_budget.count() != 0;
+    while ((playouts == 0 || playouts_ < playouts) &&
+           (!timed || Clock::now() < deadline)) {
+      Iterate();
+    }
+  }
+
+  std::uint64_t GetPlayouts() const {
+    return playouts_;
+  }
+
+  void AppendRootStats(std::vector<MoveVisitStats>& stats) const {
+    for (auto child = nodes_[0].first_child; child != kNone;
+         child = nodes_[child].next_sibling) {
+      const auto& node = nodes_[child];
+      stats.push_back(MoveVisitStats{node.cell, node.visits, node.reward});
+    }
+  }
+
+ private:
+  constexpr static std::uint32_t kNone = UINT32_MAX;
+
+  struct Node {
+    std::uint32_t cell{0};
+    std::uint32_t first_child{kNone};
+    std::uint32_t next_sibling{kNone};
+    // Legal moves without a child yet, kNone until the node is first reached
+    std::uint32_t untried{kNone};
+    std::uint64_t visits{0};
+    double reward{0};  // for the player who moved into the node
+    std::uint8_t mover{0};
+  };
+
+  static bool IsOver(const GameType& game) {
+    return game.GetAlivePlayers().size() <= 1;
+  }
+
+  void Iterate() {
+    scratch_ = root_;
+    scratch_.EnableJournal(false);
+    path_.assign(1, 0);
+
+    // Selection and expansion of one new node
+    std::uint32_t node = 0;
+    while (!IsOver(scratch_)) {
+      if (nodes_[node].untried == kNone) {
+        CollectLegalMoves(scratch_, legal_);
+        nodes_[node].untried = static_cast<std::uint32_t>(legal_.size());
+      }
+      if (nodes_[node].untried != 0) {
+        node = Expand(node);
+      } else if (nodes_[node].first_child != kNone) {
+        node = SelectChild(node);
+      } else {
+        break;  // no legal move, score the position as it is
+      }
+      path_.push_back(node);
+      scratch_.MakeMove(nodes_[node].cell);
+      if (nodes_[node].visits == 0) {
+        break;
+      }
+    }
+
+    Playout();
+    Evaluate();
+    for (auto index : path_) {
+      auto& visited = nodes_[index];
+      ++visited.visits;
+      visited.reward += rewards_[visited.mover];
+    }
+    ++playouts_;
+  }
+
+  // Add a child for a random untried move of the scratch position
+  std::uint32_t Expand(std::uint32_t parent) {
+    ++epoch_;
+    for (auto child = nodes_[parent].first_child; child != kNone;
+         child = nodes_[child].next_sibling) {
+      tried_[nodes_[child].cell] = epoch_;
+    }
+    CollectLegalMoves(scratch_, legal_);
+    std::erase_if(legal_,
+                  [this](std::uint32_t cell) { return tried_[cell] == epoch_; });
+
+    Node child;
+    child.cell = legal_[random_.Below(legal_.size())];
+    child.mover = static_cast<std::uint8_t>(scratch_.GetCurrentPlayer());
+    child.next_sibling = nodes_[parent].first_child;
+
+    auto index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.push_back(child);
+    nodes_[parent].first_child = index;
+    --nodes_[parent].untried;
+    return index;
+  }
+
+  std::uint32_t SelectChild(std::uint32_t parent) const {
+    auto log_visits = std::log(static_cast<double>(nodes_[parent].visits));
+    auto best = kNone;
+    auto best_score = -std::numeric_limits<double>::infinity();
+    for (auto child = nodes_[parent].first_child; child != kNone;
+         child = nodes_[child].next_sibling) {
+      const auto& node = nodes_[child];
+      auto visits = static_cast<double>(node.visits);
+      auto score = node.reward / visits +
+                   options_.exploration * std::sqrt(log_visits / visits);
+      if (score > best_score) {
+        best = child;
+        best_score = score;
+      }
+    }
+    return best;
+  }
+
+  std::optional<std::size_t> RandomMove() {
+    // Most cells are legal for most of the game, so sampling beats a scan
+    auto cell_count = scratch_.GetField().GetCellCount();
+    for (int attempt = 0; attempt < 16; ++attempt) {
+      auto cell = random_.Below(cell_count);
+      if (scratch_.GetField().IsLegalMove(scratch_.GetCurrentPlayer(),
+                                          cell)) {
+        return cell;
+      }
+    }
+    CollectLegalMoves(scratch_, legal_);
+    if (legal_.empty()) {
+      return std::nullopt;
+    }
+    return legal_[random_.Below(legal_.size())];
+  }
+
+  void Playout() {
+    auto limit =
+        options_.playout_moves_per_cell * scratch_.GetField().GetCellCount();
+    for (std::size_t moves = 0;
+         !IsOver(scratch_) && (limit == 0 || moves < limit); ++moves) {
+      auto cell = RandomMove();
+      if (!cell) {
+        break;
+      }
+      scratch_.MakeMove(*cell);
+    }
+  }
+
+  void Evaluate() {
+    std::fill(rewards_.begin(), rewards_.end(), 0.0);
+    auto alive = scratch_.GetAlivePlayers();
+    const auto& scores = scratch_.GetField().GetPlayerScores();
+    std::size_t best_score = 0;
+    std::size_t leaders = 0;
+    for (auto player_index : alive) {
+      if (leaders == 0 || scores[player_index] > best_score) {
+        best_score = scores[player_index];
+        leaders = 1;
+      } else if (scores[player_index] == best_score) {
+        ++leaders;
+      }
+    }
+    for (auto player_index : alive) {
+      if (scores[player_index] == best_score) {
+        rewards_[player_index] = 1.0 / static_cast<double>(leaders);
+      }
+    }
+  }
+
+  const GameType& root_;
+  const MctsOptions& options_;
+  Random random_;
+  GameType scratch_;
+  std::vector<Node> nodes_;
+  std::vector<std::uint32_t> path_;
+  std::vector<std::uint32_t> legal_;
+  // Epoch stamps marking the moves that already have a child
+  std::vector<std::uint32_t> tried_;
+  std::uint32_t epoch_{0};
+  std::vector<double> rewards_;
+  std::uint64_t playouts_{0};
+};
+
+}  // namespace
+
+template <class GameType>
+BasicMctsBot<GameType>::BasicMctsBot(MctsOptions options)
+    : options_(options) {
+  if (options_.time_budget.count() == 0 && options_.playout_budget == 0) {
+    throw errors::kNoSearchBudget;
+  }
+}
+
+template <class GameType>
+SearchResult BasicMctsBot<GameType>::Search(const GameType& game) {
+  if (game.GetAlivePlayers().size() <= 1) {
+    throw spread_logic::errors::kGameAlreadyOver;
+  }
+  std::vector<std::uint32_t> legal;
+  CollectLegalMoves(game, legal);
+  if (legal.empty()) {
+    throw errors::kNoLegalMoves;
+  }
+  if (legal.size() == 1) {
+    return SearchResult{legal.front(), 0,
+                        {MoveVisitStats{legal.front(), 0, 0}}};
+  }
+
+  std::size_t thread_count = options_.thread_count;
+  if (thread_count == 0) {
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  }
+  if (options_.playout_budget != 0) {
+    thread_count = std::min(thread_count, options_.playout_budget);
+  }
+  auto deadline = Clock::now() + options_.time_budget;
+  auto seed = Random(options_.seed + search_count_++).Next();
+
+  std::vector<TreeSearch<GameType>> searches;
+  searches.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    searches.emplace_back(game, options_, Random(seed + i).Next());
+  }
+
+  // Workers split the playout budget; the calling thread runs the first one
+  std::vector<std::exception_ptr> failures(thread_count);
+  auto run = [&](std::size_t i) {
+    auto playouts = options_.playout_budget / thread_count;
+    if (i < options_.playout_budget % thread_count) {
+      ++playouts;
+    }
+    try {
+      searches[i].Run(playouts, deadline);
+    } catch (...) {
+      failures[i] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (std::size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(run, i);
+  }
+  run(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& failure : failures) {
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+  }
+
+  // Sum the root statistics of all trees
+  SearchResult result{legal.front(), 0, {}};
+  std::vector<MoveVisitStats> stats;
+  for (const auto& search : searches) {
+    result.playouts += search.GetPlayouts();
+    search.AppendRootStats(stats);
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const MoveVisitStats& a, const MoveVisitStats& b) {
+              return a.cell_idx < b.cell_idx;
+            });
+  for (const auto& entry : stats) {
+    if (!result.moves.empty() &&
+        result.moves.back().cell_idx == entry.cell_idx) {
+      result.moves.back().visits += entry.visits;
+      result.moves.back().reward += entry.reward;
+    } else {
+      result.moves.push_back(entry);
+    }
+  }
+
+  // The most visited move is the most robust choice
+  const MoveVisitStats* best = nullptr;
+  for (const auto& move : result.moves) {
+    if (best == nullptr || move.visits > best->visits ||
+        (move.visits == best->visits && move.reward > best->reward)) {
+      best = &move;
+    }
+  }
+  if (best != nullptr) {
+    result.cell_idx = best->cell_idx;
+  }
+  return result;
+}
+
+template <class GameType>
+std::size_t BasicMctsBot<GameType>::ChooseMove(const GameType& game) {
+  return Search(game).cell_idx;
+}
+
+template class BasicMctsBot<spread_logic::Game>;
+#define SPREAD_AI_INSTANTIATE_FIXED_MCTS_BOT(width, height) \
+  template class BasicMctsBot<spread_logic::FixedGame<width, height>>;
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_AI_INSTANTIATE_FIXED_MCTS_BOT)
+#undef SPREAD_AI_INSTANTIATE_FIXED_MCTS_BOT
+#define SPREAD_AI_INSTANTIATE_VARIANT_MCTS_BOT(capture, dots) \
+  template class BasicMctsBot<spread_logic::VariantGame<capture, dots>>;
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_AI_INSTANTIATE_VARIANT_MCTS_BOT)
+#undef SPREAD_AI_INSTANTIATE_VARIANT_MCTS_BOT
+
+}  // namespace spread_ai
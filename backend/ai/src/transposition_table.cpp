@@ -0,0 +1,58 @@
+#include "transposition_table.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace spread_ai::detail {
+
+// Entry layout: move in bits 0-31, score 32-47, depth 48-55, bound 56-57 and
+// the search generation 58-63
+
+TranspositionTable::TranspositionTable(std::size_t size_mb) {
+  auto slot_count = std::bit_floor(
+      std::max<std::size_t>(size_mb * (1 << 20) / sizeof(Slot), 1));
+  slots_ = std::make_unique<Slot[]>(slot_count);
+  mask_ = slot_count - 1;
+}
+
+bool TranspositionTable::Probe(std::uint64_t key, Entry& entry) const {
+  const auto& slot = slots_[key & mask_];
+  auto data = slot.data.load(std::memory_order_relaxed);
+  auto check = slot.check.load(std::memory_order_relaxed);
+  if ((check ^ data) != key || data == 0) {
+    return false;
+  }
+  entry = Unpack(data);
+  return true;
+}
+
+void TranspositionTable::Store(std::uint64_t key, const Entry& entry) {
+  auto& slot = slots_[key & mask_];
+  auto old_data = slot.data.load(std::memory_order_relaxed);
+  auto old_check = slot.check.load(std::memory_order_relaxed);
+  if ((old_check ^ old_data) == key && (old_data >> 58) == generation_ &&
+      Unpack(old_data).depth > entry.depth) {
+    return;
+  }
+  auto data = Pack(entry, generation_);
+  slot.check.store(key ^ data, std::memory_order_relaxed);
+  slot.data.store(data, std::memory_order_relaxed);
+}
+
+std::uint64_t TranspositionTable::Pack(const Entry& entry,
+                                       std::uint64_t generation) {
+  return static_cast<std::uint64_t>(entry.move) |
+         (static_cast<std::uint64_t>(static_cast<std::uint16_t>(entry.score))
+          << 32) |
+         (static_cast<std::uint64_t>(entry.depth) << 48) |
+         (static_cast<std::uint64_t>(entry.bound) << 56) | (generation << 58);
+}
+
+TranspositionTable::Entry TranspositionTable::Unpack(std::uint64_t data) {
+  return Entry{static_cast<std::uint32_t>(data),
+               static_cast<std::int16_t>(static_cast<std::uint16_t>(data >> 32)),
+               static_cast<std::uint8_t>(data >> 48),
+               static_cast<Bound>((data >> 56) & 3)};
+}
+
+}  // namespace spread_ai::detail
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace spread_ai::detail {
+
+// Lock-free transposition table shared by all search threads.
+//
+// Every slot holds two 64-bit words: the packed entry and the entry XOR the
+// position key. Both are written with relaxed stores and no lock, so a reader
+// may see the halves of two different writes; the XOR then no longer matches
+// the key and the probe simply misses. Torn entries cost a lookup, never a
+// wrong answer for the key.
+class TranspositionTable {
+ public:
+  enum class Bound : std::uint8_t { kExact = 0, kLower = 1, kUpper = 2 };
+
+  struct Entry {
+    std::uint32_t move;
+    std::int16_t score;
+    std::uint8_t depth;
+    Bound bound;
+  };
+
+  // Rounds the size down to a power of two slots, at least one
+  explicit TranspositionTable(std::size_t size_mb);
+
+  bool Probe(std::uint64_t key, Entry& entry) const;
+
+  // Replaces the slot unless it holds a deeper result for the same key from
+  // the current search
+  void Store(std::uint64_t key, const Entry& entry);
+
+  // Start a new search: entries of older searches are replaced first
+  void NewSearch() {
+    generation_ = (generation_ + 1) & kGenerationMask;
+  }
+
+ private:
+  constexpr static std::uint64_t kGenerationMask = 0x3F;
+
+  struct Slot {
+    std::atomic<std::uint64_t> check{0};
+    std::atomic<std::uint64_t> data{0};
+  };
+
+  static std::uint64_t Pack(const Entry& entry, std::uint64_t generation);
+  static Entry Unpack(std::uint64_t data);
+
+  std::unique_ptr<Slot[]> slots_;
+  std::uint64_t mask_;
+  std::uint64_t generation_{0};
+};
+
+}  // namespace spread_ai::detail
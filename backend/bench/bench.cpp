@@ -0,0 +1,82 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+double Seconds(const BenchBody& body, std::uint64_t iterations,
+               std::uint64_t& items) {
+  auto start = std::chrono::steady_clock::now();
+  items = body(iterations);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+double Median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  auto mid = values.size() / 2;
+  return values.size() % 2 == 1 ? values[mid]
+                                 : (values[mid - 1] + values[mid]) / 2;
+}
+
+}  // namespace
+
+BenchResult RunBenchmark(const BenchCase& bench, const BenchOptions& options) {
+  auto body = bench.setup();
+  BenchResult result{bench.name, bench.item, 0, {}, 0};
+
+  std::uint64_t items = 0;
+  std::uint64_t iterations = 1;
+  for (;;) {
+    auto seconds = Seconds(body, iterations, items);
+    if (seconds >= options.min_seconds) {
+      break;
+    }
+    // Aim a bit past the target, at most 10x per step
+    auto scale = seconds > 0 ? 1.2 * options.min_seconds / seconds : 10.0;
+    iterations = std::max(iterations + 1,
+                          static_cast<std::uint64_t>(
+                              static_cast<double>(iterations) *
+                              std::min(scale, 10.0)));
+  }
+
+  result.iterations = iterations;
+  for (std::size_t rep = 0; rep < options.repetitions; ++rep) {
+    auto seconds = Seconds(body, iterations, items);
+    result.ns_per_iteration.push_back(seconds * 1e9 /
+                                      static_cast<double>(iterations));
+  }
+  result.items_per_iteration =
+      static_cast<double>(items) / static_cast<double>(iterations);
+  return result;
+}
+
+void WriteJson(std::ostream& out, const BenchOptions& options,
+               const std::vector<BenchResult>& results) {
+  out << "{\"context\":{\"compiler\":\"" << __VERSION__ << "\""
+#ifdef NDEBUG
+      << ",\"assertions\":false"
+#else
+      << ",\"assertions\":true"
+#endif
+      << ",\"min_seconds\":" << options.min_seconds
+      << ",\"repetitions\":" << options.repetitions << "},\"benchmarks\":[";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const auto& result = results[i];
+    const auto& ns = result.ns_per_iteration;
+    auto median = Median(ns);
+    out << (i > 0 ? "," : "") << "{\"name\":\"" << result.name
+        << "\",\"item\":\"" << result.item
+        << "\",\"iterations\":" << result.iterations
+        << ",\"ns_per_op\":{\"min\":" << *std::min_element(ns.begin(), ns.end())
+        << ",\"median\":" << median
+        << ",\"max\":" << *std::max_element(ns.begin(), ns.end())
+        << "},\"items_per_op\":" << result.items_per_iteration
+        << ",\"items_per_second\":"
+        << (median > 0 ? result.items_per_iteration * 1e9 / median : 0)
+        << "}";
+  }
+  out << "]}\n";
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Timed body of a benchmark: runs the operation `iterations` times and
+// returns the number of items it processed (dots placed, cells fired, bytes
+// written), so results can be compared per item across board sizes. A body
+// may be called many times and has to reset its own state.
+using BenchBody = std::function<std::uint64_t(std::uint64_t iterations)>;
+
+struct BenchCase {
+  std::string name;
+  // What the body counts, e.g. "dots"
+  std::string item;
+  // Builds the fixture outside the timed region and returns the body
+  std::function<BenchBody()> setup;
+};
+
+struct BenchOptions {
+  // Minimum duration of one repetition
+  double min_seconds{0.2};
+  std::size_t repetitions{5};
+};
+
+struct BenchResult {
+  std::string name;
+  std::string item;
+  // Per repetition, found by calibration
+  std::uint64_t iterations{0};
+  // One entry per repetition
+  std::vector<double> ns_per_iteration;
+  double items_per_iteration{0};
+};
+
+// Each file of the suite adds its cases here
+void AddEngineBenchmarks(std::vector<BenchCase>& cases);
+void AddJsonBenchmarks(std::vector<BenchCase>& cases);
+#ifdef SPREAD_BENCH_WITH_SERVER
+void AddServerBenchmarks(std::vector<BenchCase>& cases);
+#endif
+
+// Grow the iteration count until a run takes min_seconds, then time the
+// repetitions
+BenchResult RunBenchmark(const BenchCase& bench, const BenchOptions& options);
+
+// One JSON document with the options, the build and every result
+void WriteJson(std::ostream& out, const BenchOptions& options,
+               const std::vector<BenchResult>& results);
+
+// Keep the compiler from dropping a value that is computed but never used
+template <class T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
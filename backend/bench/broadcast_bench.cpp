@@ -0,0 +1,78 @@
+#include <boost/asio/basic_stream_socket.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "game_coordinator.hpp"
+#include "lobby_manager.hpp"
+#include "session.hpp"
+
+namespace {
+
+// Sessions are never started, so each one keeps the messages sent to it
+// queued in its channel and the io_context is polled rather than run. They
+// are rebuilt every kBatch broadcasts to bound that backlog; the rebuild is
+// part of the measured time.
+constexpr std::uint64_t kBatch = 64;
+
+using Socket =
+    boost::asio::basic_stream_socket<boost::asio::ip::tcp,
+                                     boost::asio::io_context::executor_type>;
+
+// GameCoordinator::BroadcastState of an 8x8 game to N sessions: the
+// game_state JSON, one dump, and one Send per session
+BenchCase Broadcast(std::size_t session_count) {
+  return {"server/broadcast/8x8_" + std::to_string(session_count) +
+              "_sessions",
+          "messages", [session_count]() -> BenchBody {
+            auto ioc = std::make_shared<boost::asio::io_context>();
+            auto lobby_manager = std::make_shared<LobbyManager>(*ioc);
+            models::Lobby lobby{"bench", "player1"};
+            lobby.options.width = 8;
+            lobby.options.height = 8;
+            for (std::size_t i = 0; i < session_count; ++i) {
+              lobby.players.push_back("player" + std::to_string(i + 1));
+            }
+            return [ioc, lobby_manager, lobby,
+                    session_count](std::uint64_t iterations) {
+              for (std::uint64_t done = 0; done < iterations;) {
+                std::vector<std::shared_ptr<Session>> sessions;
+                std::vector<std::weak_ptr<Session>> weak_sessions;
+                for (std::size_t i = 0; i < session_count; ++i) {
+                  sessions.push_back(std::make_shared<Session>(
+                      Socket(ioc->get_executor()), *lobby_manager));
+                  weak_sessions.push_back(sessions.back());
+                }
+                auto game = GameCoordinator::Create(*lobby_manager, lobby,
+                                                    ioc->get_executor(),
+                                                    std::move(weak_sessions));
+                for (std::uint64_t i = 0; i < kBatch && done < iterations;
+                     ++i, ++done) {
+                  game->BroadcastState();
+                }
+                ioc->poll();
+                ioc->restart();
+                // Drop the sessions and let their queued sends complete
+                for (const auto& session : sessions) {
+                  session->SetGame(nullptr);
+                }
+                sessions.clear();
+                game.reset();
+                ioc->poll();
+                ioc->restart();
+              }
+              return iterations * session_count;
+            };
+          }};
+}
+
+}  // namespace
+
+void AddServerBenchmarks(std::vector<BenchCase>& cases) {
+  for (std::size_t sessions : {2, 8, 64}) {
+    cases.push_back(Broadcast(sessions));
+  }
+}
@@ -0,0 +1,204 @@
+#include <string>
+
+#include "bench.hpp"
+#include "field_codec.hpp"
+#include "fixtures.hpp"
+#include "game.hpp"
+#include "move_analysis.hpp"
+
+namespace {
+
+using spread_logic::Field;
+using spread_logic::FixedField;
+
+// Fill an empty board to one dot below capacity everywhere, so no cell ever
+// fires. The reset is a copy into already allocated arrays.
+BenchCase PlaceDot(std::uint32_t width, std::uint32_t height) {
+  return {"field/place_dot/" + std::to_string(width) + "x" +
+              std::to_string(height),
+          "dots", [width, height]() -> BenchBody {
+            return [empty = Field(2, width, height),
+                    field = Field(2, width, height)](
+                       std::uint64_t iterations) mutable {
+              std::uint64_t dots = 0;
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                field = empty;
+                for (std::size_t index = 0; index < field.GetCellCount();
+                     ++index) {
+                  auto player = 1 + index % 2;
+                  for (auto dot = field.GetCell(index).capacity; dot > 1;
+                       --dot) {
+                    field.PlaceDot(player, index);
+                    ++dots;
+                  }
+                }
+              }
+              DoNotOptimize(field.StateHash());
+              return dots;
+            };
+          }};
+}
+
+// A new game's field while another game of the size is running, so the
+// static tables come from the topology cache
+BenchCase MakeField(std::uint32_t width, std::uint32_t height) {
+  return {"field/construct/" + std::to_string(width) + "x" +
+              std::to_string(height),
+          "fields", [width, height]() -> BenchBody {
+            return [running = Field(2, width, height), width, height](
+                       std::uint64_t iterations) {
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                Field field(2, width, height);
+                DoNotOptimize(field.GetCellCount());
+              }
+              DoNotOptimize(running.GetCellCount());
+              return iterations;
+            };
+          }};
+}
+
+template <class FieldType, bool kStencil>
+BenchCase SaturatedSpreadStep(const std::string& engine, std::uint32_t width,
+                              std::uint32_t height,
+                              std::size_t wave_threads = 1) {
+  return {engine + "/saturated_" + std::to_string(width) + "x" +
+              std::to_string(height),
+          "cells fired", [width, height, wave_threads]() -> BenchBody {
+            auto field = SaturatedField<FieldType>(width, height);
+            field.SetWaveThreads(wave_threads);
+            return [field = std::move(field)](
+                       std::uint64_t iterations) mutable {
+              std::uint64_t fired = 0;
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                fired += kStencil ? field.StencilSpreadStep()
+                                  : field.SpreadStep();
+              }
+              return fired;
+            };
+          }};
+}
+
+// Same wave on a hex board, where every cell walks its CSR neighbor list
+BenchCase SaturatedHexSpreadStep(std::uint32_t width, std::uint32_t height) {
+  return {"field/spread_step/saturated_hex_" + std::to_string(width) + "x" +
+              std::to_string(height),
+          "cells fired", [width, height]() -> BenchBody {
+            Field field(2, spread_logic::Topology::Hex(width, height));
+            for (std::size_t index = 0; index < field.GetCellCount();
+                 ++index) {
+              auto owner = static_cast<std::uint8_t>(1 + index % 2);
+              field.SetCell(index, owner, field.GetCell(index).capacity);
+            }
+            return [field = std::move(field)](
+                       std::uint64_t iterations) mutable {
+              std::uint64_t fired = 0;
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                fired += field.SpreadStep();
+              }
+              return fired;
+            };
+          }};
+}
+
+// Replay the move with the longest cascade found in random 16x16 games
+BenchCase LongCascadeMove() {
+  return {"game/make_move/longest_cascade_16x16", "waves", []() -> BenchBody {
+            auto position = LongestCascade(16, 16, 200, 1);
+            return [position, game = position.before](
+                       std::uint64_t iterations) mutable {
+              std::uint64_t waves = 0;
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                game = position.before;
+                game.MakeMove(position.cell_idx);
+                waves += game.GetLastCascadeWaves();
+              }
+              return waves;
+            };
+          }};
+}
+
+// Legal-move mask of a mid-game position, storage reused
+BenchCase LegalMoves(std::uint32_t width, std::uint32_t height) {
+  return {"field/legal_moves/" + std::to_string(width) + "x" +
+              std::to_string(height),
+          "cells", [width, height]() -> BenchBody {
+            return [game = MidGame(width, height, 2, width * height / 2, 1),
+                    moves = spread_logic::CellSet()](
+                       std::uint64_t iterations) mutable {
+              const auto& field = game.GetField();
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                field.LegalMoves(1 + i % 2, moves);
+                DoNotOptimize(moves.GetWords().data());
+              }
+              return iterations * field.GetCellCount();
+            };
+          }};
+}
+
+// Outcome of every legal move of a mid-game position
+BenchCase EvaluateMoves(std::uint32_t width, std::uint32_t height) {
+  return {"game/evaluate_moves/" + std::to_string(width) + "x" +
+              std::to_string(height),
+          "moves", [width, height]() -> BenchBody {
+            return [game = MidGame(width, height, 2, width * height / 2, 1)](
+                       std::uint64_t iterations) {
+              std::uint64_t moves = 0;
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                auto outcomes = spread_logic::EvaluateMoves(game);
+                moves += outcomes.size();
+                DoNotOptimize(outcomes.data());
+              }
+              return moves;
+            };
+          }};
+}
+
+// The packed encoding next to json/field_dump for the same position
+BenchCase EncodeField(std::uint32_t width, std::uint32_t height) {
+  return {"codec/encode_field/" + std::to_string(width) + "x" +
+              std::to_string(height),
+          "bytes", [width, height]() -> BenchBody {
+            return [game = MidGame(width, height, 2, width * height / 2, 1)](
+                       std::uint64_t iterations) {
+              std::uint64_t bytes = 0;
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                auto data = spread_logic::EncodeField(game.GetField());
+                bytes += data.size();
+                DoNotOptimize(data.data());
+              }
+              return bytes;
+            };
+          }};
+}
+
+}  // namespace
+
+void AddEngineBenchmarks(std::vector<BenchCase>& cases) {
+  cases.push_back(MakeField(16, 16));
+  cases.push_back(MakeField(64, 64));
+  cases.push_back(PlaceDot(8, 8));
+  cases.push_back(PlaceDot(32, 32));
+  cases.push_back(
+      SaturatedSpreadStep<Field, false>("field/spread_step", 16, 16));
+  cases.push_back(
+      SaturatedSpreadStep<Field, false>("field/spread_step", 64, 64));
+  cases.push_back(SaturatedHexSpreadStep(64, 64));
+  cases.push_back(
+      SaturatedSpreadStep<Field, true>("field/stencil_spread_step", 16, 16));
+  cases.push_back(
+      SaturatedSpreadStep<Field, true>("field/stencil_spread_step", 64, 64));
+  cases.push_back(
+      SaturatedSpreadStep<Field, true>("field/stencil_spread_step", 512, 512));
+  cases.push_back(SaturatedSpreadStep<Field, true>(
+      "field/tiled_stencil_spread_step", 512, 512, Field::kMaxWaveTiles));
+  cases.push_back(SaturatedSpreadStep<FixedField<8, 8>, false>(
+      "fixed_field/spread_step", 8, 8));
+  cases.push_back(LongCascadeMove());
+  cases.push_back(LegalMoves(8, 8));
+  cases.push_back(LegalMoves(32, 32));
+  cases.push_back(LegalMoves(128, 128));
+  cases.push_back(EvaluateMoves(8, 8));
+  cases.push_back(EvaluateMoves(32, 32));
+  cases.push_back(EncodeField(8, 8));
+  cases.push_back(EncodeField(32, 32));
+}
@@ -0,0 +1,32 @@
+#include "fixtures.hpp"
+
+spread_logic::Game MidGame(std::uint32_t width, std::uint32_t height,
+                           std::size_t players, std::size_t moves,
+                           std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  spread_logic::Game game(players, width, height);
+  for (std::size_t i = 0; i < moves && game.GetAlivePlayers().size() > 1;
+       ++i) {
+    game.MakeMove(RandomMove(game, rng));
+  }
+  return game;
+}
+
+CascadePosition LongestCascade(std::uint32_t width, std::uint32_t height,
+                               std::size_t games, std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  CascadePosition best{spread_logic::Game(2, width, height), 0, 0};
+  for (std::size_t i = 0; i < games; ++i) {
+    spread_logic::Game game(2, width, height);
+    while (game.GetAlivePlayers().size() > 1) {
+      auto before = game;
+      auto cell_idx = RandomMove(game, rng);
+      game.MakeMove(cell_idx);
+      if (game.GetLastCascadeWaves() > best.waves) {
+        best = CascadePosition{std::move(before), cell_idx,
+                               game.GetLastCascadeWaves()};
+      }
+    }
+  }
+  return best;
+}
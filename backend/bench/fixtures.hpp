@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include "game.hpp"
+
+// Deterministic positions shared by the benchmarks
+
+// Two players in a checkerboard, every cell at capacity: each wave fires
+// about the whole board and leaves it saturated again, so SpreadStep can be
+// timed in its worst case without ever reaching a stable field
+template <class FieldType>
+FieldType SaturatedField(std::uint32_t width, std::uint32_t height) {
+  FieldType field(2, width, height);
+  for (std::size_t index = 0; index < field.GetCellCount(); ++index) {
+    auto owner = static_cast<std::uint8_t>(
+        1 + (index % width + index / width) % 2);
+    field.SetCell(index, owner, field.GetCell(index).capacity);
+  }
+  return field;
+}
+
+// A uniformly random legal move for the active player
+template <class GameType>
+std::size_t RandomMove(const GameType& game, std::mt19937_64& rng) {
+  const auto& field = game.GetField();
+  auto player = game.GetCurrentPlayer();
+  for (;;) {
+    auto index = static_cast<std::size_t>(rng() % field.GetCellCount());
+    auto owner = field.GetOwner(index);
+    if (owner == 0 || owner == player) {
+      return index;
+    }
+  }
+}
+
+// Random play for up to `moves` moves, stops early if the game ends
+spread_logic::Game MidGame(std::uint32_t width, std::uint32_t height,
+                           std::size_t players, std::size_t moves,
+                           std::uint64_t seed);
+
+// The move with the longest chain reaction seen over `games` random games,
+// and the game right before it
+struct CascadePosition {
+  spread_logic::Game before;
+  std::size_t cell_idx;
+  std::size_t waves;
+};
+
+CascadePosition LongestCascade(std::uint32_t width, std::uint32_t height,
+                               std::size_t games, std::uint64_t seed);
@@ -0,0 +1,33 @@
+#include <nlohmann/json.hpp>
+#include <string>
+
+#include "bench.hpp"
+#include "fixtures.hpp"
+
+namespace {
+
+// What BroadcastState pays for the field of every game_state message
+BenchCase FieldDump(std::uint32_t width, std::uint32_t height) {
+  return {"json/field_dump/" + std::to_string(width) + "x" +
+              std::to_string(height),
+          "bytes", [width, height]() -> BenchBody {
+            return [game = MidGame(width, height, 2, width * height / 2, 1)](
+                       std::uint64_t iterations) {
+              std::uint64_t bytes = 0;
+              for (std::uint64_t i = 0; i < iterations; ++i) {
+                nlohmann::json json = game.GetField();
+                auto text = json.dump();
+                bytes += text.size();
+                DoNotOptimize(text.data());
+              }
+              return bytes;
+            };
+          }};
+}
+
+}  // namespace
+
+void AddJsonBenchmarks(std::vector<BenchCase>& cases) {
+  cases.push_back(FieldDump(8, 8));
+  cases.push_back(FieldDump(32, 32));
+}
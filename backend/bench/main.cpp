@@ -0,0 +1,111 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+struct Options {
+  BenchOptions bench;
+  std::string filter;
+  std::string output;
+  bool list{false};
+};
+
+void PrintUsage() {
+  std::cerr << "Usage: spread_bench [options]\n"
+               "  --filter=TEXT        run benchmarks whose name contains "
+               "TEXT\n"
+               "  --min-time=SECONDS   minimum time per repetition (0.2)\n"
+               "  --repetitions=N      timed repetitions per benchmark (5)\n"
+               "  --output=PATH        write JSON results there instead of "
+               "stdout\n"
+               "  --list               print the benchmark names and exit\n";
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg == "--list") {
+      options.list = true;
+      continue;
+    }
+    auto eq = arg.find('=');
+    if (!arg.starts_with("--") || eq == std::string_view::npos) {
+      return false;
+    }
+    auto key = arg.substr(2, eq - 2);
+    auto value = std::string(arg.substr(eq + 1));
+    try {
+      if (key == "filter") {
+        options.filter = value;
+      } else if (key == "min-time") {
+        options.bench.min_seconds = std::stod(value);
+      } else if (key == "repetitions") {
+        options.bench.repetitions = std::stoul(value);
+      } else if (key == "output") {
+        options.output = value;
+      } else {
+        return false;
+      }
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+  return options.bench.repetitions > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage();
+    return 1;
+  }
+
+  std::vector<BenchCase> cases;
+  AddEngineBenchmarks(cases);
+  AddJsonBenchmarks(cases);
+#ifdef SPREAD_BENCH_WITH_SERVER
+  AddServerBenchmarks(cases);
+#endif
+
+  if (options.list) {
+    for (const auto& bench : cases) {
+      std::cout << bench.name << "\n";
+    }
+    return 0;
+  }
+
+  std::vector<BenchResult> results;
+  try {
+    for (const auto& bench : cases) {
+      if (bench.name.find(options.filter) == std::string::npos) {
+        continue;
+      }
+      std::cerr << bench.name << "..." << std::flush;
+      results.push_back(RunBenchmark(bench, options.bench));
+      std::cerr << " " << results.back().ns_per_iteration.front()
+                << " ns/op\n";
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "\nBenchmark failed: " << e.what() << "\n";
+    return 1;
+  }
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output);
+    if (!file) {
+      std::cerr << "Cannot write " << options.output << "\n";
+      return 1;
+    }
+  }
+  WriteJson(options.output.empty() ? std::cout : file, options.bench,
+            results);
+  return 0;
+}
@@ -0,0 +1,247 @@
+// Differential fuzzing of the spreading engines: random games on random
+// boards run in shadow mode, so every move is checked against the reference
+// Field::SpreadStep. Covers the queue and stencil engines on Field, on
+// every FixedField size, on torus, hex, moore and map boards and on the rule
+// variants, together with Apply, Undo, EliminatePlayer and checkpoint
+// restores.
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "game.hpp"
+#include "game_codec.hpp"
+
+namespace {
+
+struct Options {
+  std::uint64_t games{10000};
+  std::uint64_t seed{0};
+  std::size_t max_actions{400};
+  std::uint32_t max_side{24};
+};
+
+void PrintUsage() {
+  std::cerr << "Usage: spread_fuzz [options]\n"
+               "  --games=N            games to play (10000)\n"
+               "  --seed=N             base seed, every game derives its own "
+               "(0)\n"
+               "  --max-actions=N      actions per game at most (400)\n"
+               "  --max-side=N         largest random board side (24)\n";
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    auto eq = arg.find('=');
+    if (!arg.starts_with("--") || eq == std::string_view::npos) {
+      return false;
+    }
+    auto key = arg.substr(2, eq - 2);
+    auto value = std::string(arg.substr(eq + 1));
+    try {
+      if (key == "games") {
+        options.games = std::stoull(value);
+      } else if (key == "seed") {
+        options.seed = std::stoull(value);
+      } else if (key == "max-actions") {
+        options.max_actions = std::stoul(value);
+      } else if (key == "max-side") {
+        options.max_side = static_cast<std::uint32_t>(std::stoul(value));
+      } else {
+        return false;
+      }
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+  return options.max_side >= 2;
+}
+
+struct GameSetup {
+  std::shared_ptr<const spread_logic::Topology> topology;
+  std::string shape;
+  std::size_t players;
+  spread_logic::EngineOptions engine;
+  spread_logic::RuleOptions rules;
+};
+
+// Random holes in a width x height map, none if every try leaves a cell
+// without neighbors
+std::shared_ptr<const spread_logic::Topology> RandomMap(
+    std::mt19937_64& rng, std::uint32_t width, std::uint32_t height) {
+  std::string map;
+  for (int attempt = 0; attempt < 8; ++attempt) {
+    map.clear();
+    for (std::uint32_t y = 0; y < height; ++y) {
+      for (std::uint32_t x = 0; x < width; ++x) {
+        map.push_back(attempt < 7 && rng() % 5 == 0 ? '#' : '.');
+      }
+      map.push_back('\n');
+    }
+    try {
+      return spread_logic::Topology::FromMap(map);
+    } catch (const std::logic_error&) {
+    }
+  }
+  return spread_logic::Topology::FromMap(map);
+}
+
+GameSetup RandomSetup(std::mt19937_64& rng, const Options& options) {
+  using spread_logic::Topology;
+  GameSetup setup{};
+  // Half of the games on other shapes, the rest on rectangles, half of those
+  // on the specialized sizes
+  constexpr std::uint32_t kFixedSides[] = {5, 6, 8, 10, 12};
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  do {
+    width = 1 + static_cast<std::uint32_t>(rng() % options.max_side);
+    height = 1 + static_cast<std::uint32_t>(rng() % options.max_side);
+  } while (width * height < 2);
+  auto shape = rng() % 8;
+  if (shape == 0 && width >= 3 && height >= 3) {
+    setup.topology = Topology::Torus(width, height);
+    setup.shape = "torus";
+  } else if (shape == 1) {
+    setup.topology = Topology::Hex(width, height);
+    setup.shape = "hex";
+  } else if (shape == 2) {
+    setup.topology = Topology::Moore(width, height);
+    setup.shape = "moore";
+  } else if (shape == 3) {
+    setup.topology = RandomMap(rng, width, height);
+    setup.shape = "map";
+  } else {
+    if (rng() % 2 == 0) {
+      width = height = kFixedSides[rng() % std::size(kFixedSides)];
+    }
+    setup.topology = Topology::Rectangle(width, height);
+    setup.shape = "rectangle";
+  }
+  setup.players = 2 + rng() % 5;
+  setup.engine.engine = rng() % 2 == 0 ? spread_logic::SpreadEngine::kQueue
+                                       : spread_logic::SpreadEngine::kStencil;
+  setup.engine.shadow = true;
+  // Tiles only kick in from Field::kTiledMinCells, e.g. with --max-side=512
+  setup.engine.wave_threads = 1 + rng() % 8;
+  // A quarter of the games on the rule variants, see
+  // SPREAD_LOGIC_RULE_VARIANTS
+  constexpr spread_logic::RuleOptions kVariants[] = {
+      {false, 1}, {true, 2}, {false, 2}};
+  if (rng() % 4 == 0) {
+    setup.rules = kVariants[rng() % std::size(kVariants)];
+  }
+  return setup;
+}
+
+// A random cell the active player may play, or any cell if none was found
+template <class GameType>
+std::size_t RandomMove(const GameType& game, std::mt19937_64& rng) {
+  const auto& field = game.GetField();
+  auto player = game.GetCurrentPlayer();
+  auto index = static_cast<std::size_t>(rng() % field.GetCellCount());
+  for (int attempt = 0; attempt < 64; ++attempt) {
+    if (field.IsLegalMove(player, index)) {
+      break;
+    }
+    index = static_cast<std::size_t>(rng() % field.GetCellCount());
+  }
+  return index;
+}
+
+// Plays random actions until the game ends, returns the number played.
+// Checkpoints are restored into a copy of the fresh game.
+template <class GameType>
+std::size_t Play(GameType& game, std::mt19937_64& rng,
+                 const Options& options) {
+  const GameType blank = game;
+  std::size_t applied = 0;
+  std::size_t actions = 0;
+  for (; actions < options.max_actions && game.GetAlivePlayers().size() > 1;
+       ++actions) {
+    auto roll = rng() % 100;
+    try {
+      if (roll < 70) {
+        game.MakeMove(RandomMove(game, rng));
+        applied = 0;
+      } else if (roll < 85) {
+        game.Apply(RandomMove(game, rng));
+        ++applied;
+      } else if (roll < 95) {
+        if (applied > 0) {
+          game.Undo();
+          --applied;
+        }
+      } else if (roll < 97) {
+        auto alive = game.GetAlivePlayers();
+        auto nth = rng() % alive.size();
+        auto it = alive.begin();
+        for (; nth > 0; --nth) {
+          ++it;
+        }
+        game.EliminatePlayer(*it);
+      } else {
+        auto data = spread_logic::EncodeGame(game);
+        auto restored = blank;
+        spread_logic::DecodeGame(data, restored);
+        game = std::move(restored);
+        applied = 0;
+      }
+    } catch (const std::logic_error& e) {
+      // The random cell belonged to another player
+      if (std::string_view(e.what()) !=
+          spread_logic::errors::kInvalidMove.what()) {
+        throw;
+      }
+    }
+  }
+  return actions;
+}
+
+std::uint64_t MixSeed(std::uint64_t seed, std::uint64_t index) {
+  std::uint64_t x = seed + 0x9E3779B97F4A7C15ULL * (index + 1);
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage();
+    return 1;
+  }
+
+  std::uint64_t actions = 0;
+  for (std::uint64_t i = 0; i < options.games; ++i) {
+    std::mt19937_64 rng(MixSeed(options.seed, i));
+    auto setup = RandomSetup(rng, options);
+    try {
+      auto game = spread_logic::MakeGame(setup.players, setup.topology,
+                                         setup.rules, setup.engine);
+      actions += std::visit(
+          [&](auto& typed) { return Play(typed, rng, options); }, game);
+    } catch (const std::exception& e) {
+      std::cerr << "Game " << i << " (--seed=" << options.seed
+                << " --games=" << i + 1 << "): " << setup.topology->GetWidth()
+                << "x" << setup.topology->GetHeight() << " " << setup.shape
+                << ", " << setup.players << " players, "
+                << (setup.engine.engine == spread_logic::SpreadEngine::kStencil
+                        ? "stencil"
+                        : "queue")
+                << " engine, " << (setup.rules.capture_enemies ? "" : "no ")
+                << "capture, " << int{setup.rules.dots_per_move}
+                << " dots per move: " << e.what() << "\n";
+      return 1;
+    }
+  }
+  std::cerr << options.games << " games, " << actions
+            << " actions, no divergence\n";
+  return 0;
+}
@@ -12,4 +12,8 @@ const std::logic_error kNotEnoughPlayers(
     "Not enough players to start the game");
 const std::logic_error kLobbyFull("Lobby is full");
 const std::logic_error kGameAlreadyStarted("Game has already started");
+const std::logic_error kInvalidBoardSize(
+    "Board size is outside the limits of the server");
+const std::logic_error kCheckpointNotFound(
+    "No saved game of the lobby has this id");
 }  // namespace errors
@@ -5,8 +5,10 @@
 #include <boost/asio/strand.hpp>
 #include <game.hpp>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "models.hpp"
 
@@ -25,6 +27,29 @@ class GameCoordinator : std::enable_shared_from_this<GameCoordinator> {
       LobbyManager& lobby_manager, const models::Lobby& lobby,
       ExecutorType exec, std::vector<std::weak_ptr<Session>> sessions);
 
+  // Board of the lobby options. Throws spread_logic::errors::kInvalidTopology
+  // on an unknown shape or a bad size or map.
+  static std::shared_ptr<const spread_logic::Topology> MakeTopology(
+      const models::LobbyOptions& options);
+
+  // Rules of the lobby options. Throws spread_logic::errors::kUnsupportedRules
+  // for a rule set without a compiled engine.
+  static spread_logic::RuleOptions MakeRules(
+      const models::LobbyOptions& options);
+
+  // Resume the lobby's game from a checkpoint made by Checkpoint, the lobby
+  // players taking the seats in join order. Throws
+  // spread_logic::errors::kCheckpointMismatch if it was made for another
+  // board, rule set or player count, or the spread_logic decoding errors if
+  // it is malformed.
+  static std::shared_ptr<GameCoordinator> Restore(
+      LobbyManager& lobby_manager, const models::Lobby& lobby,
+      ExecutorType exec, std::vector<std::weak_ptr<Session>> sessions,
+      std::span<const std::uint8_t> checkpoint);
+
+  // Binary snapshot of the game, see spread_logic::EncodeGame
+  boost::asio::awaitable<std::vector<std::uint8_t>> Checkpoint();
+
   boost::asio::awaitable<void> MakeMove(const std::string& player_id,
                                         std::size_t cell_idx);
 
@@ -43,11 +68,18 @@ class GameCoordinator : std::enable_shared_from_this<GameCoordinator> {
 
   boost::asio::awaitable<void> BroadcastStateImpl();
 
+  boost::asio::awaitable<std::vector<std::uint8_t>> CheckpointImpl();
+
   boost::asio::awaitable<void> EndGame();
 
+  // Point the sessions at a newly created coordinator
+  static void Attach(const std::shared_ptr<GameCoordinator>& game);
+
  private:
   LobbyManager& lobby_manager_;
-  spread_logic::Game game_;
+  // Runs on a fixed-size engine when one matches the lobby board size, on the
+  // engine compiled for the lobby rules otherwise
+  spread_logic::AnyGame game_;
   std::string id_;
   std::vector<std::string> players_;
   std::unordered_map<std::string, std::size_t> player_to_idx_;
@@ -3,10 +3,12 @@
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/strand.hpp>
+#include <cstdint>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "game_coordinator.hpp"
 #include "models.hpp"
@@ -14,12 +16,19 @@
 // Forward declaration
 class Session;
 
+// Largest boards clients may create lobbies for. The engine takes far larger
+// ones, these keep a single lobby from claiming the memory of the server.
+struct BoardLimits {
+  int max_side = 512;
+  std::int64_t max_cells = 1 << 18;
+};
+
 class LobbyManager {
   using ExecutorType = boost::asio::io_context::executor_type;
 
  public:
-  explicit LobbyManager(boost::asio::io_context& ioc)
-      : strand_(ioc.get_executor()) {
+  explicit LobbyManager(boost::asio::io_context& ioc, BoardLimits limits = {})
+      : strand_(ioc.get_executor()), limits_(limits) {
   }
   ~LobbyManager() = default;
 
@@ -35,9 +44,18 @@ class LobbyManager {
   boost::asio::awaitable<void> LeaveLobby(const std::string& player_id);
   boost::asio::awaitable<nlohmann::json> ListLobbies() const;
 
-  boost::asio::awaitable<void> StartGame(const std::string& player_id);
+  // Start the lobby's game, or resume the saved game of the lobby when a
+  // checkpoint id from SaveGame is given
+  boost::asio::awaitable<void> StartGame(const std::string& player_id,
+                                         std::string checkpoint_id = {});
   boost::asio::awaitable<void> EndGame(const std::string& lobby_id);
 
+  // Keep a checkpoint of the player's game, made by
+  // GameCoordinator::Checkpoint, as the saved game of the lobby. Replaces the
+  // previous one; returns the id StartGame takes.
+  boost::asio::awaitable<std::string> SaveGame(
+      const std::string& player_id, std::vector<std::uint8_t> checkpoint);
+
  private:
   // Running under strand
   void SendToAll(const nlohmann::json msg);
@@ -53,12 +71,16 @@ class LobbyManager {
                                              const std::string& player_id);
   boost::asio::awaitable<void> LeaveLobbyImpl(const std::string& player_id);
   boost::asio::awaitable<nlohmann::json> ListLobbiesImpl() const;
-  boost::asio::awaitable<void> StartGameImpl(const std::string& player_id);
+  boost::asio::awaitable<void> StartGameImpl(const std::string& player_id,
+                                             std::string checkpoint_id);
+  boost::asio::awaitable<std::string> SaveGameImpl(
+      const std::string& player_id, std::vector<std::uint8_t> checkpoint);
   boost::asio::awaitable<void> UpdateStatusImpl(const std::string& lobby_id,
                                                 models::LobbyStatus status);
 
  private:
   boost::asio::strand<ExecutorType> strand_;
+  BoardLimits limits_;
   // lobby_id -> active game
   std::unordered_map<std::string, std::weak_ptr<GameCoordinator>> games_;
   // player_id -> weak session
@@ -67,6 +89,14 @@ class LobbyManager {
   std::unordered_map<std::string, models::Lobby> lobbies_;
   // player_id -> lobby_id (membership)
   std::unordered_map<std::string, std::string> membership_;
+  // lobby_id -> last saved game. Checkpoints never leave the server, so a
+  // resumed game is one the server played.
+  struct SavedGame {
+    std::string id;
+    std::vector<std::uint8_t> checkpoint;
+  };
+  std::unordered_map<std::string, SavedGame> saved_games_;
   int lobby_counter_ = 1;
   int player_counter_ = 1;
+  int checkpoint_counter_ = 1;
 };
@@ -11,6 +11,13 @@ struct LobbyOptions {
   int max_players = 4;
   int width = 8;
   int height = 8;
+  // Board shape: "rectangle", "torus", "hex", "moore" for eight neighbors or
+  // "map" for the designer map below, whose size replaces width and height
+  std::string topology = "rectangle";
+  std::string map;
+  // Rule variants, see spread_logic::SpreadRules
+  bool capture_enemies = true;
+  int dots_per_move = 1;
 };
 
 enum class LobbyStatus { Open, InProgress, Finished };
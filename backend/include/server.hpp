@@ -12,7 +12,8 @@ class Server {
       boost::asio::basic_socket_acceptor<boost::asio::ip::tcp, ExecutorType>;
 
  public:
-  Server(boost::asio::io_context& ioc, unsigned short port);
+  Server(boost::asio::io_context& ioc, unsigned short port,
+         BoardLimits limits = {});
   void Start();
 
  private:
@@ -55,6 +55,7 @@ class Session : public std::enable_shared_from_this<Session> {
   boost::asio::awaitable<void> HandleLeaveLobby(const nlohmann::json& msg);
   boost::asio::awaitable<void> HandleStartGame(const nlohmann::json& msg);
   boost::asio::awaitable<void> HandleMakeMove(const nlohmann::json& msg);
+  boost::asio::awaitable<void> HandleSaveGame(const nlohmann::json& msg);
 
  private:
   LobbyManager& lobby_manager_;
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "player_set.hpp"
+#include "topology.hpp"
+
+namespace spread_logic {
+
+struct Sides {
+  enum : std::uint8_t { NONE = 0, TOP = 1, RIGHT = 2, BOTTOM = 4, LEFT = 8 };
+
+  constexpr static std::uint8_t kTraverse[] = {TOP, RIGHT, BOTTOM, LEFT};
+};
+
+// Maximum number of neighbors a cell of a rectangle can have (one per side)
+constexpr std::size_t kMaxNeighbors = 4;
+
+// Board sizes with a compile-time specialized engine, as X(width, height).
+// Other sizes run on the dynamic engine.
+#define SPREAD_LOGIC_FIXED_BOARD_SIZES(X) \
+  X(5, 5)                                 \
+  X(6, 6)                                 \
+  X(8, 8)                                 \
+  X(10, 10)                               \
+  X(12, 12)
+
+// Fill the static tables of a width x height rectangle: the Sides bits and
+// the capacity of every cell and, unless offsets is null, its neighbor list
+// in CSR form (see Topology) in Sides::kTraverse order; neighbors needs room
+// for kMaxNeighbors per cell.
+constexpr void BuildBoardTables(std::uint32_t width, std::uint32_t height,
+                                std::uint8_t* configuration,
+                                std::uint8_t* capacity, std::uint32_t* offsets,
+                                std::uint32_t* neighbors) {
+  std::uint32_t index = 0;
+  std::uint32_t next = 0;
+  if (offsets != nullptr) {
+    offsets[0] = 0;
+  }
+  for (std::uint32_t y = 0; y < height; ++y) {
+    for (std::uint32_t x = 0; x < width; ++x, ++index) {
+      std::uint8_t config = 0;
+      if (y > 0) {
+        config |= Sides::TOP;
+      }
+      if (x + 1 < width) {
+        config |= Sides::RIGHT;
+      }
+      if (y + 1 < height) {
+        config |= Sides::BOTTOM;
+      }
+      if (x > 0) {
+        config |= Sides::LEFT;
+      }
+      configuration[index] = config;
+      capacity[index] = static_cast<std::uint8_t>(std::popcount(config));
+
+      if (offsets != nullptr) {
+        if ((config & Sides::TOP) != 0) {
+          neighbors[next++] = index - width;
+        }
+        if ((config & Sides::RIGHT) != 0) {
+          neighbors[next++] = index + 1;
+        }
+        if ((config & Sides::BOTTOM) != 0) {
+          neighbors[next++] = index + width;
+        }
+        if ((config & Sides::LEFT) != 0) {
+          neighbors[next++] = index - 1;
+        }
+        offsets[index + 1] = next;
+      }
+    }
+  }
+}
+
+// Vector interface over inline storage for at most N elements
+template <class T, std::size_t N>
+class StaticVector {
+ public:
+  // NOLINTBEGIN(readability-identifier-naming)
+  bool empty() const {
+    return size_ == 0;
+  }
+  std::size_t size() const {
+    return size_;
+  }
+  T* data() {
+    return items_.data();
+  }
+  T* begin() {
+    return items_.data();
+  }
+  T* end() {
+    return items_.data() + size_;
+  }
+  const T* begin() const {
+    return items_.data();
+  }
+  const T* end() const {
+    return items_.data() + size_;
+  }
+  void push_back(const T& value) {
+    items_[size_++] = value;
+  }
+  void clear() {
+    size_ = 0;
+  }
+  // Growing leaves the new elements unspecified
+  void resize(std::size_t size) {
+    size_ = size;
+  }
+  // Costs the larger of the two sizes, not N
+  void swap(StaticVector& other) {
+    auto count = std::max(size_, other.size_);
+    for (std::size_t i = 0; i < count; ++i) {
+      std::swap(items_[i], other.items_[i]);
+    }
+    std::swap(size_, other.size_);
+  }
+  // NOLINTEND(readability-identifier-naming)
+
+ private:
+  std::array<T, N> items_{};
+  std::size_t size_{0};
+};
+
+// Storage of a board whose shape is known at runtime. The static tables are
+// an immutable Topology shared by all boards of the same shape; generated
+// shapes come from a process-wide cache, built by the first board of a size
+// and freed with the last one. A field only owns its mutable cells and
+// copying one copies no tables. Rectangles above kNeighborTableMaxCells
+// cells skip the neighbor list and derive neighbors from the configuration
+// bits, which keeps the static data at two bytes per cell.
+class DynamicBoard {
+ public:
+  // Cell indices are 32-bit
+  constexpr static std::size_t kMaxCellCount = UINT32_MAX;
+
+  constexpr static std::size_t kNeighborTableMaxCells =
+      Topology::kNeighborListMaxCells;
+
+  template <class T>
+  using CellArray = std::vector<T>;
+  template <class T>
+  using PlayerArray = std::vector<T>;
+  using CellQueue = std::vector<std::uint32_t>;
+
+  // A rectangle
+  DynamicBoard(std::uint32_t width, std::uint32_t height);
+
+  explicit DynamicBoard(std::shared_ptr<const Topology> topology);
+
+  static bool IsValidSize(std::uint32_t width, std::uint32_t height) {
+    auto cell_count = static_cast<std::uint64_t>(width) * height;
+    return cell_count >= 2 && cell_count <= kMaxCellCount;
+  }
+
+  std::uint32_t GetWidth() const {
+    return width_;
+  }
+  std::uint32_t GetHeight() const {
+    return height_;
+  }
+  std::size_t GetCellCount() const {
+    return cell_count_;
+  }
+  const std::uint8_t* GetConfiguration() const {
+    return configuration_;
+  }
+  const std::uint8_t* GetCapacity() const {
+    return capacity_;
+  }
+  // Both null on boards without a neighbor list
+  const std::uint32_t* GetNeighborOffsets() const {
+    return offsets_;
+  }
+  const std::uint32_t* GetNeighbors() const {
+    return neighbors_;
+  }
+  // Blocked cells in CellSet layout, null if there are none
+  const std::uint64_t* GetBlocked() const {
+    return blocked_;
+  }
+  bool IsGrid() const {
+    return grid_;
+  }
+  const std::shared_ptr<const Topology>& GetTopology() const {
+    return topology_;
+  }
+  template <class T>
+  CellArray<T> MakeCellArray() const {
+    return CellArray<T>(GetCellCount(), T{});
+  }
+  template <class T>
+  static PlayerArray<T> MakePlayerArray(std::size_t player_count) {
+    return PlayerArray<T>(player_count + 1, T{});
+  }
+
+ private:
+  std::uint32_t width_;
+  std::uint32_t height_;
+  std::size_t cell_count_;
+  std::shared_ptr<const Topology> topology_;
+  // Tables of topology_, kept here to spare the hot loops an indirection
+  const std::uint8_t* configuration_;
+  const std::uint8_t* capacity_;
+  const std::uint32_t* offsets_;
+  const std::uint32_t* neighbors_;
+  const std::uint64_t* blocked_;
+  bool grid_;
+};
+
+// Storage of a W x H board known at compile time: constexpr static tables
+// and fixed-size cell arrays and queues, so a field needs no heap memory
+// unless the journal or the stencil engine is used.
+template <std::uint32_t W, std::uint32_t H>
+class FixedBoard {
+ public:
+  constexpr static std::size_t kCellCount = std::size_t{W} * H;
+  static_assert(kCellCount >= 2 &&
+                kCellCount <= DynamicBoard::kNeighborTableMaxCells);
+
+  template <class T>
+  using CellArray = std::array<T, kCellCount>;
+  template <class T>
+  using PlayerArray = std::array<T, kMaxPlayers + 1>;
+  using CellQueue = StaticVector<std::uint32_t, kCellCount>;
+
+  // The size is part of the type, the arguments only mirror DynamicBoard
+  FixedBoard(std::uint32_t /*width*/, std::uint32_t /*height*/) {
+  }
+
+  static bool IsValidSize(std::uint32_t width, std::uint32_t height) {
+    return width == W && height == H;
+  }
+
+  constexpr static std::uint32_t GetWidth() {
+    return W;
+  }
+  constexpr static std::uint32_t GetHeight() {
+    return H;
+  }
+  constexpr static std::size_t GetCellCount() {
+    return kCellCount;
+  }
+  static const std::uint8_t* GetConfiguration() {
+    return kTables.configuration.data();
+  }
+  static const std::uint8_t* GetCapacity() {
+    return kTables.capacity.data();
+  }
+  static const std::uint32_t* GetNeighborOffsets() {
+    return kTables.offsets.data();
+  }
+  static const std::uint32_t* GetNeighbors() {
+    return kTables.neighbors.data();
+  }
+  constexpr static const std::uint64_t* GetBlocked() {
+    return nullptr;
+  }
+  constexpr static bool IsGrid() {
+    return true;
+  }
+  // The shared rectangle of this size, for code that wants a Topology
+  static std::shared_ptr<const Topology> GetTopology() {
+    return Topology::Rectangle(W, H);
+  }
+  template <class T>
+  static CellArray<T> MakeCellArray() {
+    return CellArray<T>{};
+  }
+  template <class T>
+  static PlayerArray<T> MakePlayerArray(std::size_t /*player_count*/) {
+    return PlayerArray<T>{};
+  }
+
+ private:
+  struct Tables {
+    std::array<std::uint8_t, kCellCount> configuration;
+    std::array<std::uint8_t, kCellCount> capacity;
+    std::array<std::uint32_t, kCellCount + 1> offsets;
+    std::array<std::uint32_t, kCellCount * kMaxNeighbors> neighbors;
+  };
+
+  constexpr static Tables kTables = [] {
+    Tables tables{};
+    BuildBoardTables(W, H, tables.configuration.data(), tables.capacity.data(),
+                     tables.offsets.data(), tables.neighbors.data());
+    return tables;
+  }();
+};
+
+}  // namespace spread_logic
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace spread_logic {
+
+// Set of cell indices of one board as a bitset: cell i is bit i % 64 of word
+// i / 64, bits past the last cell stay clear. Iterates in ascending order.
+class CellSet {
+ public:
+  class Iterator {
+   public:
+    Iterator(const std::uint64_t* words, std::size_t word_count,
+             std::size_t word_index)
+        : words_(words),
+          word_count_(word_count),
+          word_index_(word_index) {
+      bits_ = word_index_ < word_count_ ? words_[word_index_] : 0;
+      SkipEmpty();
+    }
+
+    std::size_t operator*() const {
+      return word_index_ * 64 +
+             static_cast<std::size_t>(std::countr_zero(bits_));
+    }
+
+    Iterator& operator++() {
+      bits_ &= bits_ - 1;
+      SkipEmpty();
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return word_index_ == other.word_index_ && bits_ == other.bits_;
+    }
+
+   private:
+    void SkipEmpty() {
+      while (bits_ == 0 && word_index_ < word_count_) {
+        if (++word_index_ < word_count_) {
+          bits_ = words_[word_index_];
+        }
+      }
+    }
+
+    const std::uint64_t* words_;
+    std::size_t word_count_;
+    std::size_t word_index_;
+    std::uint64_t bits_;
+  };
+
+  CellSet() = default;
+
+  // Empty set over cell_count cells
+  explicit CellSet(std::size_t cell_count)
+      : words_(WordCount(cell_count), 0),
+        cell_count_(cell_count) {
+  }
+
+  // Clear the set and size it for cell_count cells, keeping the storage
+  void Reset(std::size_t cell_count) {
+    words_.assign(WordCount(cell_count), 0);
+    cell_count_ = cell_count;
+  }
+
+  static std::size_t WordCount(std::size_t cell_count) {
+    return (cell_count + 63) / 64;
+  }
+
+  std::size_t GetCellCount() const {
+    return cell_count_;
+  }
+
+  std::span<std::uint64_t> GetWords() {
+    return words_;
+  }
+  std::span<const std::uint64_t> GetWords() const {
+    return words_;
+  }
+
+  bool Contains(std::size_t index) const {
+    return index < cell_count_ &&
+           ((words_[index / 64] >> (index % 64)) & 1) != 0;
+  }
+
+  void Insert(std::size_t index) {
+    words_[index / 64] |= std::uint64_t{1} << (index % 64);
+  }
+
+  void Erase(std::size_t index) {
+    words_[index / 64] &= ~(std::uint64_t{1} << (index % 64));
+  }
+
+  // NOLINTBEGIN(readability-identifier-naming)
+  bool empty() const {
+    for (auto word : words_) {
+      if (word != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+  std::size_t size() const {
+    std::size_t count = 0;
+    for (auto word : words_) {
+      count += static_cast<std::size_t>(std::popcount(word));
+    }
+    return count;
+  }
+  Iterator begin() const {
+    return Iterator(words_.data(), words_.size(), 0);
+  }
+  Iterator end() const {
+    return Iterator(words_.data(), words_.size(), words_.size());
+  }
+  // NOLINTEND(readability-identifier-naming)
+
+  bool operator==(const CellSet& other) const = default;
+
+ private:
+  std::vector<std::uint64_t> words_;
+  std::size_t cell_count_{0};
+};
+
+}  // namespace spread_logic
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace spread_logic {
+
+// One cell modified by a move. Wave 0 is the placed dot, wave N the N-th
+// SpreadStep of the cascade.
+struct CellChange {
+  std::uint32_t cell_idx;
+  std::uint32_t wave;
+  std::uint8_t old_owner;
+  std::uint8_t new_owner;
+  std::uint8_t old_fullness;
+  std::uint8_t new_fullness;
+};
+
+// Changes of one move, ordered by wave and by cell index within a wave. Only
+// cells whose owner or fullness differ after the wave are listed.
+using ChangeSet = std::span<const CellChange>;
+
+}  // namespace spread_logic
@@ -1,17 +1,31 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <optional>
-#include <queue>
+#include <span>
+#include <type_traits>
 #include <vector>
 
+#include "board.hpp"
+#include "cell_set.hpp"
+#include "change_set.hpp"
+#include "rules.hpp"
+
 namespace spread_logic {
 
-struct Sides {
-  enum : std::uint8_t { NONE = 0, TOP = 1, RIGHT = 2, BOTTOM = 4, LEFT = 8 };
+namespace detail {
+struct WaveGrid;
+}  // namespace detail
 
-  constexpr static std::uint8_t kTraverse[] = {TOP, RIGHT, BOTTOM, LEFT};
-};
+// Per-move engine statistics, see MoveStats. Off when the library is built
+// without ENABLE_MOVE_STATS, leaving no counting code in the engines.
+#ifdef SPREAD_LOGIC_ENABLE_MOVE_STATS
+constexpr bool kMoveStatsEnabled = true;
+#else
+constexpr bool kMoveStatsEnabled = false;
+#endif
 
 struct Coordinate {
   std::int32_t x;
@@ -40,52 +54,353 @@ class Cell {
   std::uint8_t owner_index{0};
 };
 
-class Field {
+// The field engine over a board storage, DynamicBoard for any size or
+// FixedBoard for a size known at compile time, playing by a SpreadRules set.
+// Both boards behave the same; see Field, FixedField and VariantField below.
+template <class Board, class Rules = ClassicRules>
+class BasicField {
  public:
-  Field(std::size_t player_count, std::uint8_t width, std::uint8_t height);
+  using BoardType = Board;
+  using RulesType = Rules;
+
+  constexpr static std::size_t kMaxNeighbors = spread_logic::kMaxNeighbors;
+
+  constexpr static std::size_t kMaxCellCount = DynamicBoard::kMaxCellCount;
+
+  // Boards up to this many cells keep a precomputed neighbor table
+  constexpr static std::size_t kNeighborTableMaxCells =
+      DynamicBoard::kNeighborTableMaxCells;
+
+  // Read-only view over the field that assembles Cell records from the dense
+  // per-cell arrays on access.
+  class CellsView {
+   public:
+    class Iterator {
+     public:
+      Iterator(const BasicField* field, std::size_t index)
+          : field_(field),
+            index_(index) {
+      }
+
+      Cell operator*() const {
+        return field_->GetCell(index_);
+      }
+
+      Iterator& operator++() {
+        ++index_;
+        return *this;
+      }
+
+      bool operator==(const Iterator& other) const = default;
 
+     private:
+      const BasicField* field_;
+      std::size_t index_;
+    };
+
+    explicit CellsView(const BasicField* field)
+        : field_(field) {
+    }
+
+    Cell operator[](std::size_t index) const {
+      return field_->GetCell(index);
+    }
+
+    std::size_t size() const {  // NOLINT(readability-identifier-naming)
+      return field_->GetCellCount();
+    }
+
+    Iterator begin() const {  // NOLINT(readability-identifier-naming)
+      return Iterator(field_, 0);
+    }
+
+    Iterator end() const {  // NOLINT(readability-identifier-naming)
+      return Iterator(field_, size());
+    }
+
+   private:
+    const BasicField* field_;
+  };
+
+  // Fixed-size fields ignore width and height, Game checks them with
+  // IsValidSize
+  BasicField(std::size_t player_count, std::uint32_t width,
+             std::uint32_t height);
+
+  // Field on a hex, torus or designer map, see Topology
+  BasicField(std::size_t player_count, std::shared_ptr<const Topology> topology)
+    requires std::is_same_v<Board, DynamicBoard>;
+
+  static bool IsValidSize(std::uint32_t width, std::uint32_t height) {
+    return Board::IsValidSize(width, height);
+  }
+
+  // Run one wave of the chain reaction: every overfull cell fires once, in
+  // ascending index order, sending one dot to each neighbor and taking it
+  // over, or losing the dot to an enemy cell without Rules::kCaptureEnemies.
+  // Returns the number of cells that fired, 0 once the field is stable.
   std::size_t SpreadStep();
 
-  std::vector<std::size_t>& GetPlayerScores();
-  const std::vector<std::size_t>& GetPlayerScores() const;
+  // Same as SpreadStep, but computes the wave as a stencil over the whole
+  // grid with SIMD kernels selected at runtime. Produces identical cells and
+  // scores; pays off when a wave touches a large part of the board. Runs
+  // SpreadStep on topologies other than the plain rectangle and under rules
+  // without Rules::kCaptureEnemies.
+  std::size_t StencilSpreadStep();
+
+  // Split StencilSpreadStep waves of boards with at least kTiledMinCells
+  // cells into row tiles run on up to `threads` threads of a shared pool.
+  // Cells, scores, journal and hash come out identical to the serial wave.
+  // The default of 1 keeps every wave on the calling thread.
+  void SetWaveThreads(std::size_t threads) {
+    wave_threads_ = std::max<std::size_t>(threads, 1);
+  }
+  std::size_t GetWaveThreads() const {
+    return wave_threads_;
+  }
+
+  constexpr static std::size_t kTiledMinCells = 1 << 16;
+  // Smallest tile worth a thread, and the tile limit of one wave
+  constexpr static std::size_t kMinTileCells = 1 << 14;
+  constexpr static std::size_t kMaxWaveTiles = 64;
+
+  // Dots of each player, index 0 unused
+  std::span<std::uint64_t> GetPlayerScores() {
+    return {player_scores_.data(), player_count_ + 1};
+  }
+  std::span<const std::uint64_t> GetPlayerScores() const {
+    return {player_scores_.data(), player_count_ + 1};
+  }
+
+  // Number of cells owned by each player, kept up to date on every ownership
+  // change. Index 0 counts the unowned cells.
+  std::span<const std::uint32_t> GetOwnedCells() const {
+    return {owned_cells_.data(), player_count_ + 1};
+  }
+
+  // Cells taken over from one player by another since the field was created.
+  // SpreadStep counts every takeover, StencilSpreadStep the net change of
+  // each cell per wave. Stays 0 without kMoveStatsEnabled.
+  std::uint64_t GetOwnerFlips() const {
+    return owner_flips_;
+  }
+
+  // Players that lost their last cell since the previous call and still own
+  // nothing. Clears the recorded events.
+  PlayerMask TakeEliminated();
+
+  // Recorded events as they are, for saving and restoring a position
+  PlayerMask GetPendingEliminated() const {
+    return eliminated_;
+  }
+  void SetPendingEliminated(PlayerMask eliminated) {
+    eliminated_ = eliminated;
+  }
+
+  // Opt-in change journal. While enabled, PlaceDot starts a new journal and
+  // every wave appends the cells it changed, so consumers can follow a move
+  // in O(changed cells). The buffer is reused between moves.
+  void EnableJournal(bool enabled);
+  bool IsJournalEnabled() const {
+    return journal_enabled_;
+  }
+  ChangeSet GetChanges() const {
+    return journal_;
+  }
 
-  const std::vector<Cell>& GetCells() const;
+  // Counters of a position that cells alone do not give back, saved before a
+  // move so RevertMove can restore them
+  struct UndoMark {
+    PlayerMask eliminated;
+  };
 
-  // Place a dot for the given player at the position if rules allow (unowned or
-  // already owned by that player). Returns true if the dot was placed, false if
-  // the move is invalid or out of bounds.
+  UndoMark GetUndoMark() const {
+    return UndoMark{eliminated_};
+  }
+
+  // Undo a move from its journal: restore the cells in reverse order together
+  // with scores and owned-cell counts. The field must have been settled
+  // before the move, so the spread queue ends up empty.
+  void RevertMove(ChangeSet changes, const UndoMark& mark);
+
+  // Incremental 64-bit Zobrist hash of the position: the XOR of
+  // ZobristKey(cell, owner, fullness) over all non-empty cells. The spread
+  // queue is implied by the cells, so equal hashes mean equal positions up to
+  // collisions. Updated in O(1) per cell change.
+  std::uint64_t StateHash() const {
+    return hash_;
+  }
+
+  // Fixed pseudo-random key of a cell state, 0 for an empty cell. Keys do not
+  // depend on the process, so hashes can be stored and compared later.
+  static std::uint64_t ZobristKey(std::uint32_t cell_idx, std::uint8_t owner,
+                                  std::uint8_t fullness);
+
+  CellsView GetCells() const;
+
+  Cell GetCell(std::size_t index) const;
+
+  // Owner and fullness of a cell without assembling a Cell record, for hot
+  // loops
+  std::uint8_t GetOwner(std::size_t index) const {
+    return owner_[index];
+  }
+  std::uint8_t GetFullness(std::size_t index) const {
+    return fullness_[index];
+  }
+  // Dots at which the cell spreads, 0 for a blocked cell
+  std::uint8_t GetCapacity(std::size_t index) const {
+    return board_.GetCapacity()[index];
+  }
+
+  // Cells the player may place a dot on: the unowned ones and its own.
+  // Computed from the owner array with the SIMD kernels, 64 cells per word
+  // of the result. The second form reuses the storage of `moves`.
+  CellSet LegalMoves(std::size_t player_index) const;
+  void LegalMoves(std::size_t player_index, CellSet& moves) const;
+  // The same test for one cell
+  bool IsLegalMove(std::size_t player_index, std::size_t index) const {
+    auto owner = owner_[index];
+    return (owner == 0 || owner == player_index) && GetCapacity(index) != 0;
+  }
+
+  // Overwrite the state of a cell, e.g. when loading a saved position. Keeps
+  // scores, owned-cell counts, the hash and the spread queue consistent; the
+  // journal does not record it. An empty cell must be unowned.
+  void SetCell(std::size_t index, std::uint8_t owner, std::uint8_t fullness);
+
+  std::size_t GetPlayerCount() const {
+    return player_count_;
+  }
+
+  std::size_t GetCellCount() const {
+    return board_.GetCellCount();
+  }
+
+  // Place Rules::kDotsPerMove dots for the given player at the position if
+  // rules allow (unowned or already owned by that player, not blocked).
+  // Returns true if the dots were placed, false if the move is invalid or out
+  // of bounds.
   bool PlaceDot(std::size_t player_index, std::size_t cell_idx);
 
   std::optional<std::size_t> GetIndex(Coordinate pos) const;
 
   // Dimensions
-  std::uint8_t GetWidth() const {
-    return width_;
+  std::uint32_t GetWidth() const {
+    return board_.GetWidth();
   }
-  std::uint8_t GetHeight() const {
-    return height_;
+  std::uint32_t GetHeight() const {
+    return board_.GetHeight();
+  }
+  std::shared_ptr<const Topology> GetTopology() const {
+    return board_.GetTopology();
   }
 
  private:
-  void Fill();
-
-  std::uint8_t CalcConfiguration(Coordinate pos) const;
+  BasicField(std::size_t player_count, Board board);
 
   std::size_t ToIndex(Coordinate pos) const;
 
   Coordinate ToCoordinate(std::size_t index) const;
 
-  Coordinate MoveTo(Coordinate pos, std::uint8_t direction) const;
+  void ChangeOwner(std::size_t index, std::uint8_t new_owner);
+
+  // Move one cell between the owned-cell counters, recording an elimination
+  // event when the previous owner is left with nothing
+  void TransferCell(std::uint8_t from, std::uint8_t to);
+
+  // Call fn(neighbor_index) for every neighbor in topology order, which is
+  // Sides::kTraverse order on rectangles
+  template <class Fn>
+  void ForEachNeighbor(std::uint32_t index, Fn&& fn) const;
+
+  // Add a dot to the cell, returns true if the cell became filled by it
+  bool AddDot(std::size_t index);
+
+  // Owner of every cell of the current wave at the moment it fires, for the
+  // stencil kernel
+  void ResolveFiredOwners();
+
+  // Tiles StencilSpreadStep splits the current wave into, 1 for serial
+  std::size_t WaveTileCount() const;
+
+  // One stencil wave over tile_count row tiles, each applying its rows
+  // into its own counters and its own slice of the change and next lists,
+  // merged in tile order at the end. Returns the number of fired cells.
+  std::size_t TiledWave(const detail::WaveGrid& grid, std::size_t tile_count,
+                        std::size_t& change_count);
+
+  std::uint64_t CellKey(std::uint32_t index) const {
+    return ZobristKey(index, owner_[index], fullness_[index]);
+  }
 
-  void ChangeOwner(Cell& cell, std::uint8_t new_owner);
+  // Journal bookkeeping: open a wave, note a cell before its first change in
+  // the wave, and close the wave by filling in the new values
+  void BeginJournalWave();
+  void RecordChange(std::uint32_t index);
+  void EndJournalWave();
 
-  std::uint8_t width_;
-  std::uint8_t height_;
-  std::vector<std::uint64_t> player_scores_;
-  std::vector<Cell> cells_;
-  std::queue<std::size_t> spread_queue_;
+  // Static per-cell data: configuration, capacity and the neighbor table
+  Board board_;
+  std::size_t player_count_;
+  typename Board::template PlayerArray<std::uint64_t> player_scores_;
+  typename Board::template PlayerArray<std::uint32_t> owned_cells_;
+  PlayerMask eliminated_{0};
+  std::uint64_t owner_flips_{0};
+  std::uint64_t hash_{0};
+
+  // Mutable per-cell state
+  typename Board::template CellArray<std::uint8_t> fullness_;
+  typename Board::template CellArray<std::uint8_t> owner_;
+
+  // Overfull cells waiting to fire, each exactly once
+  typename Board::CellQueue spread_queue_;
+  typename Board::CellQueue wave_;
+
+  bool journal_enabled_{false};
+  std::vector<CellChange> journal_;
+  // Epoch of the wave that last recorded each cell
+  std::vector<std::uint32_t> journal_stamp_;
+  std::uint32_t journal_epoch_{0};
+  std::uint32_t journal_wave_{0};
+  std::size_t journal_wave_begin_{0};
+
+  // Guarded buffers of the stencil engine, allocated on first use. The
+  // kernel reports changed cells to wave_changes_ when the journal is off.
+  std::vector<std::uint8_t> ready_;
+  std::vector<std::uint8_t> fired_owner_;
+  std::vector<CellChange> wave_changes_;
+
+  std::size_t wave_threads_{1};
+  // Score and owned-cell deltas of each tile, player_count_ + 1 per tile
+  std::vector<std::uint64_t> tile_scores_;
+  std::vector<std::uint32_t> tile_owned_cells_;
 };
 
+// Field of any size
+using Field = BasicField<DynamicBoard>;
+
+// Field specialized for a W x H board, see SPREAD_LOGIC_FIXED_BOARD_SIZES
+template <std::uint32_t W, std::uint32_t H>
+using FixedField = BasicField<FixedBoard<W, H>>;
+
+// Field of any size playing by a rule set of SPREAD_LOGIC_RULE_VARIANTS
+template <bool kCaptureEnemies, std::uint8_t kDotsPerMove>
+using VariantField =
+    BasicField<DynamicBoard, SpreadRules<kCaptureEnemies, kDotsPerMove>>;
+
+// Defined in field.cpp for the dynamic board, the fixed sizes and the rule
+// variants
+extern template class BasicField<DynamicBoard>;
+#define SPREAD_LOGIC_EXTERN_FIELD(width, height) \
+  extern template class BasicField<FixedBoard<width, height>>;
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_EXTERN_FIELD)
+#undef SPREAD_LOGIC_EXTERN_FIELD
+#define SPREAD_LOGIC_EXTERN_VARIANT_FIELD(capture, dots) \
+  extern template class BasicField<DynamicBoard, SpreadRules<capture, dots>>;
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_EXTERN_VARIANT_FIELD)
+#undef SPREAD_LOGIC_EXTERN_VARIANT_FIELD
+
 }  // namespace spread_logic
 
 #ifdef SPREAD_LOGIC_ENABLE_JSON
@@ -95,7 +410,8 @@ class Field {
 namespace spread_logic {
 // NOLINTBEGIN(readability-identifier-naming)
 void to_json(::nlohmann::json& j, const Cell& cell);
-void to_json(::nlohmann::json& j, const Field& field);
+template <class Board, class Rules>
+void to_json(::nlohmann::json& j, const BasicField<Board, Rules>& field);
 
 void from_json(const ::nlohmann::json& j, Cell& cell);
 // NOLINTEND(readability-identifier-naming)
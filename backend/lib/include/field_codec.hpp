@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "field.hpp"
+
+namespace spread_logic {
+
+namespace errors {
+const std::logic_error kInvalidFieldEncoding{"Invalid packed field data"};
+}  // namespace errors
+
+// Packed binary encoding of a field, a compact alternative to to_json:
+//
+//   version      byte, kFieldEncodingVersion
+//   flags        byte, bit 0 set when empty runs are run-length encoded
+//   width        varint
+//   height       varint
+//   player count byte
+//   scores       varint per player, players 1 to player count
+//   cells        in index order
+//
+// Varints are LEB128. A cell is one byte, owner in the high nibble and
+// fullness in the low one. Owner nibble 15 is an escape:
+//   0xF0 owner fullness   a cell that does not fit the nibbles
+//   0xF1 varint           a run of that many empty cells, with the flag
+//
+// Scores are stored because EliminatePlayer zeroes them while the cells
+// stay; everything else follows from the cells. Of the topology only width
+// and height are stored: a field on another shape decodes into a field built
+// on the same Topology, DecodeField(data) alone gives a rectangle.
+constexpr std::uint8_t kFieldEncodingVersion = 1;
+
+struct FieldHeader {
+  std::uint32_t width;
+  std::uint32_t height;
+  std::size_t player_count;
+};
+
+template <class Board, class Rules>
+std::vector<std::uint8_t> EncodeField(const BasicField<Board, Rules>& field,
+                                      bool run_length = true);
+
+// The header, e.g. to pick the field type before decoding. The cells are
+// checked against it first, so the data holds a byte per cell of the board
+// except for runs of empty cells: with run-length encoding a short input may
+// describe a huge empty board, callers taking untrusted data bound the size
+// themselves. Throws errors::kInvalidFieldEncoding.
+FieldHeader ReadFieldHeader(std::span<const std::uint8_t> data);
+
+// Load the encoded state into a field of the same dimensions and player
+// count. Cells must hold fewer dots than their capacity, as on a settled
+// field, and blocked cells none; allow_overfull accepts the overfull cells a
+// cascade cut short leaves behind. Throws errors::kInvalidFieldEncoding on
+// malformed or mismatching data, leaving the field in an unspecified state.
+template <class Board, class Rules>
+void DecodeField(std::span<const std::uint8_t> data,
+                 BasicField<Board, Rules>& field, bool allow_overfull = false);
+
+Field DecodeField(std::span<const std::uint8_t> data);
+
+}  // namespace spread_logic
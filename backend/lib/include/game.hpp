@@ -1,7 +1,9 @@
 #pragma once
 
-#include <list>
+#include <optional>
 #include <stdexcept>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
 #include "field.hpp"
@@ -13,6 +15,12 @@ const std::logic_error kInvalidMove{
     "Invalid move: out of bounds or not allowed"};
 const std::logic_error kPlayerNotAlive{"Invalid move: player is not alive"};
 const std::logic_error kGameAlreadyOver{"Game is already over"};
+const std::logic_error kTooManyPlayers{"Too many players for one game"};
+const std::logic_error kNothingToUndo{"No applied move to undo"};
+const std::logic_error kInvalidBoardSize{
+    "Invalid board size: needs at least two cells and 32-bit cell indices"};
+const std::logic_error kEngineMismatch{
+    "Spreading engine diverged from the reference engine"};
 }  // namespace errors
 
 struct Move {
@@ -20,13 +28,87 @@ struct Move {
   std::size_t cell_idx;
 };
 
-class Game {
+// How a game runs its chain reactions. Every engine gives the same result,
+// they differ in speed depending on the board and the cascade.
+enum class SpreadEngine : std::uint8_t {
+  kQueue,    // Field::SpreadStep, the reference
+  kStencil,  // Field::StencilSpreadStep
+};
+
+struct EngineOptions {
+  SpreadEngine engine{SpreadEngine::kQueue};
+  // Mirror every move on a reference Field running SpreadStep and compare
+  // cells, scores and owned-cell counts after it. A move that diverges
+  // throws errors::kEngineMismatch once it is made; the game keeps the
+  // result of its own engine and should be dropped. Costs a second field
+  // and O(cells) per move.
+  bool shadow{false};
+  // kStencil only: split the waves of huge boards into tiles run on up to
+  // this many threads, see Field::SetWaveThreads
+  std::size_t wave_threads{1};
+};
+
+// Cost of the chain reaction of one move, returned by MakeMove and Apply.
+// Covers every wave that ran, the one after the last elimination included.
+// Counted in place without allocating; all zero when kMoveStatsEnabled is off.
+struct MoveStats {
+  // Waves of the chain reaction, as GetLastCascadeWaves
+  std::uint32_t waves{0};
+  // Cells popped from the spread queue over all waves
+  std::uint64_t cells_fired{0};
+  // Cells taken over from another player, see Field::GetOwnerFlips
+  std::uint64_t owner_flips{0};
+  // Most cells that fired in one wave
+  std::uint32_t peak_queue{0};
+  // Players the move knocked out, including those an endless cascade ends
+  PlayerMask eliminated{0};
+};
+
+template <class FieldType>
+class BasicGame;
+
+// Game of any board size
+using Game = BasicGame<Field>;
+
+// Anything that picks moves for a game of GameType, e.g. a bot
+template <class GameType>
+class BasicMoveSource {
+ public:
+  virtual ~BasicMoveSource() = default;
+
+  // Cell to play for the active player of the game
+  virtual std::size_t ChooseMove(const GameType& game) = 0;
+};
+
+using MoveSource = BasicMoveSource<Game>;
+
+// The game rules over a field engine, Field, one of the FixedField sizes or
+// a VariantField
+template <class FieldType>
+class BasicGame {
  public:
-  Game(std::size_t player_count, std::uint8_t width, std::uint8_t height);
+  BasicGame(std::size_t player_count, std::uint32_t width,
+            std::uint32_t height, EngineOptions options = {});
+
+  // Game on a hex, torus or designer map, see Topology. Plays like a
+  // rectangle; kStencil falls back to the queue engine off the grid.
+  BasicGame(std::size_t player_count, std::shared_ptr<const Topology> topology,
+            EngineOptions options = {})
+    requires std::is_same_v<typename FieldType::BoardType, DynamicBoard>;
+
+  EngineOptions GetEngineOptions() const {
+    return {engine_, reference_.has_value(), field_.GetWaveThreads()};
+  }
+
+  // Rule set of the field engine, fixed by FieldType
+  constexpr static RuleOptions GetRuleOptions() {
+    return FieldType::RulesType::kOptions;
+  }
 
-  // Active player index (1-based to match owner_index in Field)
+  // Active player index (1-based to match owner_index in Field), 0 once no
+  // player is alive
   std::size_t GetCurrentPlayer() const {
-    return *current_player_;
+    return current_player_;
   }
 
   std::size_t GetCurrentTurn() const {
@@ -37,12 +119,59 @@ class Game {
     return move_history_;
   }
 
-  const Field& GetField() const {
+  const FieldType& GetField() const {
     return field_;
   }
 
+  // Cells the active player may play, see Field::LegalMoves
+  CellSet GetLegalMoves() const {
+    return field_.LegalMoves(current_player_);
+  }
+
+  // Zobrist hash of the position and the side to move, see Field::StateHash
+  std::uint64_t GetHash() const;
+
+  // Record the cells changed by each move, see Field::EnableJournal
+  void EnableJournal(bool enabled) {
+    field_.EnableJournal(enabled);
+  }
+
+  // Cells changed by the last move, empty unless the journal is enabled
+  ChangeSet GetLastChanges() const {
+    return field_.GetChanges();
+  }
+
+  // Waves of the chain reaction of the latest move, 0 if nothing fired
+  std::size_t GetLastCascadeWaves() const {
+    return last_cascade_waves_;
+  }
+
+  // Cascades running longer than this many waves per cell are treated as
+  // endless. Settling cascades stay far below it: random play on boards up to
+  // 16x16 never needed more than 2 waves per cell.
+  constexpr static std::size_t kMaxCascadeWavesPerCell = 64;
+
   // Make a move for the active player at position.
-  void MakeMove(std::size_t cell_idx);
+  //
+  // The cascade runs until the field settles or one player is left. A board
+  // holding more dots than it can keep at rest never settles, but its cascade
+  // fires every cell it reaches, so it runs until the mover has taken the
+  // others out. A cascade that repeats an earlier position or exceeds
+  // kMaxCascadeWavesPerCell waves per cell ends the game instead: the alive
+  // player with the most dots wins, ties going to the mover and then to turn
+  // order. This bounds the cost of a move.
+  MoveStats MakeMove(std::size_t cell_idx);
+
+  // Make the move the source picks for the active player
+  MoveStats MakeMove(BasicMoveSource<BasicGame>& source);
+
+  // Make a move that Undo can take back, for search and move previews. Follows
+  // the same rules as MakeMove and turns the change journal on.
+  MoveStats Apply(std::size_t cell_idx);
+
+  // Take back the latest Apply. Costs time proportional to the cells the
+  // move changed. MakeMove commits and drops everything that could be undone.
+  void Undo();
 
   // Advance to next alive player
   void NextTurn();
@@ -50,19 +179,119 @@ class Game {
   // Eliminate a player, noop if not alive
   void EliminatePlayer(std::size_t player_idx);
 
-  // Return indices of alive players (1-based)
-  const std::list<std::size_t>& GetAlivePlayers() const;
+  // Return indices of alive players (1-based), in turn order
+  PlayerSet GetAlivePlayers() const {
+    return alive_players_;
+  }
+
+  // Loads a checkpoint into every member, see game_codec.hpp
+  template <class F>
+  friend void DecodeGame(std::span<const std::uint8_t> data,
+                         BasicGame<F>& game);
 
  private:
   void UpdateAliveness();
 
-  Field field_;
+  // Run the chain reaction, returns false if it was cut as endless
+  bool RunCascade(MoveStats& stats);
+
+  // Leave only the winner of an endless cascade alive
+  void ResolveEndlessCascade(std::size_t mover);
+
+  // MakeMove without touching the undo log
+  MoveStats PlayMove(std::size_t cell_idx);
+
+  // One wave on the selected engine, mirrored on the reference in shadow
+  // mode
+  std::size_t SpreadStep();
+
+  // Shadow mode: throw errors::kEngineMismatch unless the reference field
+  // holds the same position
+  void CheckReference() const;
+
+  // Shadow mode: copy the position into the reference field, after changes
+  // that are not replayed on it
+  void SyncReference();
+
+  // Game state before an applied move; the cells it changed are kept in
+  // undo_changes_ starting at changes_begin
+  struct UndoFrame {
+    std::size_t changes_begin;
+    PlayerSet alive;
+    std::size_t current_player;
+    std::size_t turn_count;
+    typename FieldType::UndoMark field_mark;
+  };
+
+  FieldType field_;
   std::vector<Move> move_history_;
-  std::list<std::size_t> alive_players_;
-  std::list<std::size_t>::iterator current_player_;
+  // Turn order is ascending player index over the alive players
+  PlayerSet alive_players_;
+  std::size_t current_player_;
   std::size_t turn_count_{0};
+  std::size_t last_cascade_waves_{0};
+  std::vector<UndoFrame> undo_frames_;
+  std::vector<CellChange> undo_changes_;
+  SpreadEngine engine_;
+  // Reference engine of shadow mode, on the same rules
+  std::optional<BasicField<DynamicBoard, typename FieldType::RulesType>>
+      reference_;
 };
 
+// Game specialized for a W x H board, see SPREAD_LOGIC_FIXED_BOARD_SIZES
+template <std::uint32_t W, std::uint32_t H>
+using FixedGame = BasicGame<FixedField<W, H>>;
+
+// Game of any size playing by a rule set of SPREAD_LOGIC_RULE_VARIANTS
+template <bool kCaptureEnemies, std::uint8_t kDotsPerMove>
+using VariantGame = BasicGame<VariantField<kCaptureEnemies, kDotsPerMove>>;
+
+// Defined in game.cpp for the dynamic board, the fixed sizes and the rule
+// variants
+extern template class BasicGame<Field>;
+#define SPREAD_LOGIC_EXTERN_GAME(width, height) \
+  extern template class BasicGame<FixedField<width, height>>;
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_EXTERN_GAME)
+#undef SPREAD_LOGIC_EXTERN_GAME
+#define SPREAD_LOGIC_EXTERN_VARIANT_GAME(capture, dots) \
+  extern template class BasicGame<VariantField<capture, dots>>;
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_EXTERN_VARIANT_GAME)
+#undef SPREAD_LOGIC_EXTERN_VARIANT_GAME
+
+// A game on the fastest engine for its board size and rules
+#define SPREAD_LOGIC_FIXED_GAME_ALTERNATIVE(width, height) \
+  , FixedGame<width, height>
+#define SPREAD_LOGIC_VARIANT_GAME_ALTERNATIVE(capture, dots) \
+  , VariantGame<capture, dots>
+using AnyGame = std::variant<Game SPREAD_LOGIC_FIXED_BOARD_SIZES(
+    SPREAD_LOGIC_FIXED_GAME_ALTERNATIVE) SPREAD_LOGIC_RULE_VARIANTS(
+    SPREAD_LOGIC_VARIANT_GAME_ALTERNATIVE)>;
+#undef SPREAD_LOGIC_VARIANT_GAME_ALTERNATIVE
+#undef SPREAD_LOGIC_FIXED_GAME_ALTERNATIVE
+
+// Create a game on a FixedGame when one matches the board size, on Game
+// otherwise. Throws like the Game constructor.
+AnyGame MakeGame(std::size_t player_count, std::uint32_t width,
+                 std::uint32_t height, EngineOptions options = {});
+
+// Same for any topology: rectangles go through the overload above, other
+// shapes run on Game. Throws like the Game constructor.
+AnyGame MakeGame(std::size_t player_count,
+                 std::shared_ptr<const Topology> topology,
+                 EngineOptions options = {});
+
+// Same under the given rules: the classic rules go through the overload
+// above, the rule sets of SPREAD_LOGIC_RULE_VARIANTS run on their
+// VariantGame. Throws errors::kUnsupportedRules for any other rule set, and
+// like the Game constructor.
+AnyGame MakeGame(std::size_t player_count,
+                 std::shared_ptr<const Topology> topology, RuleOptions rules,
+                 EngineOptions options = {});
+
+// True if MakeGame has an engine for the rule set, e.g. to check options
+// long before the game starts
+bool HasEngine(RuleOptions rules);
+
 #ifdef SPREAD_LOGIC_ENABLE_JSON
 // NOLINTBEGIN(readability-identifier-naming)
 void to_json(nlohmann::json& j, const Move& move);
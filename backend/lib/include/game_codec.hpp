@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "field_codec.hpp"
+#include "game.hpp"
+
+namespace spread_logic {
+
+namespace errors {
+const std::logic_error kInvalidGameEncoding{"Invalid game checkpoint data"};
+const std::logic_error kCheckpointMismatch{
+    "Checkpoint was made for another board, rule set or player count"};
+}  // namespace errors
+
+// Versioned binary checkpoint of a whole game:
+//
+//   version        byte, kGameEncodingVersion
+//   field size     varint
+//   field          EncodeField data
+//   rules          byte capture enemies (0 or 1), byte dots per move
+//   topology       byte TopologyKind, then for kMap a bit per cell, set for
+//                  holes, and for kCustom the degree and neighbors of each
+//                  cell as varints; the field gives the size
+//   alive players  varint, PlayerMask
+//   current player byte
+//   turn count     varint
+//   cascade waves  varint, GetLastCascadeWaves
+//   eliminations   varint, PlayerMask of pending field events
+//   move count     varint
+//   moves          player byte and cell varint each
+//
+// Varints are LEB128. The pending spread queue is made of the overfull cells,
+// so it comes back with the field; only a finished game may have any. Moves
+// made with Apply are saved like any other move, a restored game cannot Undo
+// them.
+//
+// Version 1 stored neither rules nor topology and is no longer read.
+constexpr std::uint8_t kGameEncodingVersion = 2;
+
+struct GameHeader {
+  FieldHeader field;
+  RuleOptions rules;
+  TopologyKind topology_kind;
+};
+
+template <class FieldType>
+std::vector<std::uint8_t> EncodeGame(const BasicGame<FieldType>& game);
+
+// Size, player count, rules and board kind of a checkpoint, e.g. to check
+// them against the caller's limits before decoding. Builds no board, the size
+// is bounded like ReadFieldHeader. Throws errors::kInvalidGameEncoding or
+// errors::kInvalidFieldEncoding.
+GameHeader ReadGameHeader(std::span<const std::uint8_t> data);
+
+// Load a checkpoint into a game with the same player count, rules and
+// topology, dropping its undo log. The header is compared with the game
+// before any board is built, so the size of the game bounds the work. Throws
+// errors::kCheckpointMismatch if they differ, errors::kInvalidGameEncoding or
+// errors::kInvalidFieldEncoding on malformed data, leaving the game in an
+// unspecified state.
+template <class FieldType>
+void DecodeGame(std::span<const std::uint8_t> data,
+                BasicGame<FieldType>& game);
+
+// Restore a checkpoint on the engine MakeGame picks for its board and rules.
+// Builds the board of any size the header names, callers taking untrusted
+// data check ReadGameHeader against their limits first. Engine options are
+// not part of the checkpoint. Throws like ReadGameHeader, and
+// errors::kUnsupportedRules for rules without an engine in this build.
+AnyGame DecodeGame(std::span<const std::uint8_t> data,
+                   EngineOptions options = {});
+
+}  // namespace spread_logic
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "game.hpp"
+#include "player_set.hpp"
+
+namespace spread_logic {
+
+// What one candidate move would lead to
+struct MoveOutcome {
+  std::uint32_t cell_idx{0};
+  // Dots of each player after the move, index 0 unused
+  std::vector<std::uint64_t> scores;
+  // Waves of its chain reaction, see Game::GetLastCascadeWaves
+  std::size_t cascade_waves{0};
+  // Players the move knocks out, including those an endless cascade ends
+  PlayerMask eliminated{0};
+  // At most one player is left alive afterwards
+  bool ends_game{false};
+};
+
+// Play every legal move of the active player on private copies of the game
+// and report where each one leads, in ascending cell order. The moves are
+// spread over the engine's shared thread pool; the game itself is only read,
+// so it must not change until the call returns. Empty once the game is over.
+// Rethrows the first engine error, e.g. errors::kEngineMismatch in shadow
+// mode.
+template <class FieldType>
+std::vector<MoveOutcome> EvaluateMoves(const BasicGame<FieldType>& game);
+
+std::vector<MoveOutcome> EvaluateMoves(const AnyGame& game);
+
+}  // namespace spread_logic
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace spread_logic {
+
+// One bit per player, bit (player_index - 1)
+using PlayerMask = std::uint64_t;
+
+constexpr std::size_t kMaxPlayers = 64;
+
+inline PlayerMask PlayerBit(std::size_t player_index) {
+  return PlayerMask{1} << (player_index - 1);
+}
+
+// Set of player indices (1-based) stored in a PlayerMask. Iterates in
+// ascending order without allocating.
+class PlayerSet {
+ public:
+  class Iterator {
+   public:
+    explicit Iterator(PlayerMask mask)
+        : mask_(mask) {
+    }
+
+    std::size_t operator*() const {
+      return static_cast<std::size_t>(std::countr_zero(mask_)) + 1;
+    }
+
+    Iterator& operator++() {
+      mask_ &= mask_ - 1;
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const = default;
+
+   private:
+    PlayerMask mask_;
+  };
+
+  PlayerSet() = default;
+
+  explicit PlayerSet(PlayerMask mask)
+      : mask_(mask) {
+  }
+
+  // Players 1 to count
+  static PlayerSet FirstN(std::size_t count) {
+    return PlayerSet(count >= kMaxPlayers ? ~PlayerMask{0}
+                                          : (PlayerMask{1} << count) - 1);
+  }
+
+  PlayerMask GetMask() const {
+    return mask_;
+  }
+
+  bool Contains(std::size_t player_index) const {
+    return player_index >= 1 && player_index <= kMaxPlayers &&
+           (mask_ & PlayerBit(player_index)) != 0;
+  }
+
+  void Insert(std::size_t player_index) {
+    mask_ |= PlayerBit(player_index);
+  }
+
+  void Erase(std::size_t player_index) {
+    if (Contains(player_index)) {
+      mask_ &= ~PlayerBit(player_index);
+    }
+  }
+
+  // Next player after the given one in turn order, wrapping around to the
+  // lowest index; the player itself need not be in the set. 0 if empty.
+  std::size_t NextAfter(std::size_t player_index) const {
+    auto above = player_index >= kMaxPlayers
+                     ? PlayerMask{0}
+                     : mask_ & ~((PlayerMask{1} << player_index) - 1);
+    auto next = above != 0 ? above : mask_;
+    return next == 0 ? 0 : static_cast<std::size_t>(std::countr_zero(next)) + 1;
+  }
+
+  // NOLINTBEGIN(readability-identifier-naming)
+  bool empty() const {
+    return mask_ == 0;
+  }
+  std::size_t size() const {
+    return static_cast<std::size_t>(std::popcount(mask_));
+  }
+  // Lowest player index, the set must not be empty
+  std::size_t front() const {
+    return *begin();
+  }
+  Iterator begin() const {
+    return Iterator(mask_);
+  }
+  Iterator end() const {
+    return Iterator(0);
+  }
+  // NOLINTEND(readability-identifier-naming)
+
+  bool operator==(const PlayerSet& other) const = default;
+
+ private:
+  PlayerMask mask_{0};
+};
+
+}  // namespace spread_logic
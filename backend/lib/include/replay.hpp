@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace spread_logic {
+
+struct ReplayResult {
+  // The replay reached the checkpointed position
+  bool verified{false};
+  // Why it did not, empty if verified
+  std::string error;
+  std::size_t moves{0};
+  // Players removed without a move of theirs, see ReplayCheckpoint
+  std::size_t inferred_eliminations{0};
+  // GetHash of the replayed game
+  std::uint64_t hash{0};
+  // Time spent replaying moves, decoding not included
+  std::chrono::nanoseconds elapsed{0};
+};
+
+// Replay the move history of a game checkpoint (see EncodeGame) through
+// MakeMove from an empty board of its topology, on the engine MakeGame picks
+// for its board and rules, and compare the result with the checkpointed game:
+// hash, alive players, current player and turn count, plus scores when no
+// elimination was inferred.
+//
+// The history does not record players dropped with EliminatePlayer, e.g. on
+// disconnect. When the next recorded mover is not the active player, the
+// players skipped in turn order are eliminated first; players missing from
+// the final alive set are eliminated at the end. Scores of such games are not
+// compared, since they depend on when the elimination happened.
+//
+// Never throws on bad input, malformed checkpoints and rejected moves are
+// reported in the result.
+ReplayResult ReplayCheckpoint(std::span<const std::uint8_t> checkpoint);
+
+}  // namespace spread_logic
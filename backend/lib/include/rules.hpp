@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace spread_logic {
+
+namespace errors {
+const std::logic_error kUnsupportedRules{
+    "Unsupported rules: no engine is compiled for this rule set"};
+}  // namespace errors
+
+// Runtime description of a rule set, to pick the engine compiled for it
+struct RuleOptions {
+  bool capture_enemies{true};
+  std::uint8_t dots_per_move{1};
+
+  bool operator==(const RuleOptions& other) const = default;
+};
+
+// Rules a field plays by, a template parameter of BasicField so every rule
+// set gets its own SpreadStep and PlaceDot with no branch on the rules in
+// them. The shape of the board, cell capacities and blocked cells are not
+// rules but data of its Topology.
+template <bool kCaptureEnemiesValue, std::uint8_t kDotsPerMoveValue>
+struct SpreadRules {
+  static_assert(kDotsPerMoveValue >= 1);
+
+  // A firing cell takes over every neighbor it sends a dot to. Without it
+  // the dots aimed at cells of other players leave the board, and those
+  // cells keep their owner and fullness.
+  constexpr static bool kCaptureEnemies = kCaptureEnemiesValue;
+  // Dots PlaceDot puts on the cell in one move
+  constexpr static std::uint8_t kDotsPerMove = kDotsPerMoveValue;
+
+  constexpr static RuleOptions kOptions{kCaptureEnemies, kDotsPerMove};
+};
+
+using ClassicRules = SpreadRules<true, 1>;
+
+// Rule sets with a compiled engine besides ClassicRules, as
+// X(capture_enemies, dots_per_move). They run on the dynamic board only,
+// the fixed sizes keep the classic rules.
+#define SPREAD_LOGIC_RULE_VARIANTS(X) \
+  X(false, 1)                         \
+  X(true, 2)                          \
+  X(false, 2)
+
+}  // namespace spread_logic
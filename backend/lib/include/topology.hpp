@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace spread_logic {
+
+namespace errors {
+const std::logic_error kInvalidTopology{
+    "Invalid board topology: bad size, map or neighbor list"};
+}  // namespace errors
+
+enum class TopologyKind : std::uint8_t {
+  kRectangle,  // grid with four sides, the classic board
+  kTorus,      // rectangle whose edges wrap around
+  kHex,        // hexagons in offset rows, odd rows shifted right
+  kMoore,      // rectangle whose cells also touch diagonally, 8 neighbors
+  kMap,        // designer map, a rectangle with holes
+  kCustom,     // any neighbor list
+};
+
+// Immutable cell graph of a board, shared by every field played on it. Cells
+// are laid out row-major over width x height; cell i neighbors cells
+// neighbors[offsets[i] .. offsets[i + 1]) and its capacity is that degree.
+// Blocked cells, the holes of a map, have no neighbors and cannot be played.
+//
+// Rectangles above kNeighborListMaxCells cells skip the neighbor list, the
+// engine derives their neighbors from the Sides bits of GetConfiguration.
+// GetConfiguration holds the sides a cell has orthogonal neighbors on for
+// kRectangle, kTorus and kMap, and is 0 for the other kinds.
+class Topology {
+ public:
+  constexpr static std::size_t kNeighborListMaxCells = 1 << 16;
+  // Fullness is a byte. A cell fires whenever it holds its capacity and gets
+  // at most its degree in dots per wave, so it stays below twice the capacity.
+  constexpr static std::size_t kMaxDegree = 127;
+
+  // The factories throw `error` on bad input, errors::kInvalidTopology unless
+  // the caller has its own, e.g. the checkpoint decoder.
+
+  // Cached per size, see DynamicBoard. Throw for fewer than two cells and, on
+  // a torus, sides below 3, which would make a cell its own neighbor.
+  static std::shared_ptr<const Topology> Rectangle(
+      std::uint32_t width, std::uint32_t height,
+      const std::logic_error& error = errors::kInvalidTopology);
+  static std::shared_ptr<const Topology> Torus(
+      std::uint32_t width, std::uint32_t height,
+      const std::logic_error& error = errors::kInvalidTopology);
+  static std::shared_ptr<const Topology> Hex(
+      std::uint32_t width, std::uint32_t height,
+      const std::logic_error& error = errors::kInvalidTopology);
+  static std::shared_ptr<const Topology> Moore(
+      std::uint32_t width, std::uint32_t height,
+      const std::logic_error& error = errors::kInvalidTopology);
+
+  // Designer map, one line per row: '.' for a cell, '#' for a hole. Cells
+  // neighbor the cells on their four sides. Throws on ragged rows, other
+  // characters, fewer than two cells or a cell without neighbors.
+  static std::shared_ptr<const Topology> FromMap(
+      std::string_view map,
+      const std::logic_error& error = errors::kInvalidTopology);
+
+  // Any graph over width x height cells in CSR form, each edge listed from
+  // both ends. Throws on malformed offsets, neighbors out of range, self
+  // loops, one-way edges, degrees above kMaxDegree or fewer than two playable
+  // cells.
+  static std::shared_ptr<const Topology> FromNeighbors(
+      std::uint32_t width, std::uint32_t height,
+      std::vector<std::uint32_t> offsets, std::vector<std::uint32_t> neighbors,
+      const std::logic_error& error = errors::kInvalidTopology);
+
+  TopologyKind GetKind() const {
+    return kind_;
+  }
+  std::uint32_t GetWidth() const {
+    return width_;
+  }
+  std::uint32_t GetHeight() const {
+    return height_;
+  }
+  std::size_t GetCellCount() const {
+    return capacity_.size();
+  }
+  // The stencil engine runs only on plain rectangles
+  bool IsGrid() const {
+    return kind_ == TopologyKind::kRectangle;
+  }
+
+  const std::uint8_t* GetConfiguration() const {
+    return configuration_.data();
+  }
+  const std::uint8_t* GetCapacity() const {
+    return capacity_.data();
+  }
+  // Both null on rectangles without a neighbor list
+  const std::uint32_t* GetNeighborOffsets() const {
+    return offsets_.empty() ? nullptr : offsets_.data();
+  }
+  const std::uint32_t* GetNeighbors() const {
+    return offsets_.empty() ? nullptr : neighbors_.data();
+  }
+  // Blocked cells in CellSet layout, null if there are none
+  const std::uint64_t* GetBlocked() const {
+    return blocked_.empty() ? nullptr : blocked_.data();
+  }
+  bool IsBlocked(std::size_t index) const {
+    return capacity_[index] == 0;
+  }
+
+  // Same kind, size and neighbor lists, e.g. a board rebuilt from a
+  // checkpoint
+  bool operator==(const Topology& other) const;
+
+ private:
+  Topology() = default;
+
+  // Capacity and blocked mask from the neighbor list
+  void Finish(const std::logic_error& error);
+
+  TopologyKind kind_{TopologyKind::kRectangle};
+  std::uint32_t width_{0};
+  std::uint32_t height_{0};
+  std::vector<std::uint8_t> configuration_;
+  std::vector<std::uint8_t> capacity_;
+  std::vector<std::uint32_t> offsets_;
+  std::vector<std::uint32_t> neighbors_;
+  std::vector<std::uint64_t> blocked_;
+};
+
+}  // namespace spread_logic
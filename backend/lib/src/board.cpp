@@ -0,0 +1,22 @@
+#include "board.hpp"
+
+namespace spread_logic {
+
+DynamicBoard::DynamicBoard(std::uint32_t width, std::uint32_t height)
+    : DynamicBoard(Topology::Rectangle(width, height)) {
+}
+
+DynamicBoard::DynamicBoard(std::shared_ptr<const Topology> topology)
+    : width_(topology->GetWidth()),
+      height_(topology->GetHeight()),
+      cell_count_(topology->GetCellCount()),
+      topology_(std::move(topology)),
+      configuration_(topology_->GetConfiguration()),
+      capacity_(topology_->GetCapacity()),
+      offsets_(topology_->GetNeighborOffsets()),
+      neighbors_(topology_->GetNeighbors()),
+      blocked_(topology_->GetBlocked()),
+      grid_(topology_->IsGrid()) {
+}
+
+}  // namespace spread_logic
@@ -0,0 +1,70 @@
+#pragma once
+
+// Byte-level helpers shared by the binary field and game encodings
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace spread_logic::detail {
+
+// LEB128
+inline void WriteVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Bounds-checked reader, throws the given error on truncated or malformed
+// input
+class ByteReader {
+ public:
+  ByteReader(std::span<const std::uint8_t> data, const std::logic_error& error)
+      : data_(data),
+        error_(error) {
+  }
+
+  std::uint8_t Byte() {
+    if (pos_ >= data_.size()) {
+      throw error_;
+    }
+    return data_[pos_++];
+  }
+
+  std::uint64_t Varint() {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      auto byte = Byte();
+      value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw error_;
+  }
+
+  // Take the next size bytes as a span
+  std::span<const std::uint8_t> Bytes(std::size_t size) {
+    if (size > data_.size() - pos_) {
+      throw error_;
+    }
+    auto bytes = data_.subspan(pos_, size);
+    pos_ += size;
+    return bytes;
+  }
+
+  bool AtEnd() const {
+    return pos_ == data_.size();
+  }
+
+ private:
+  std::span<const std::uint8_t> data_;
+  const std::logic_error& error_;
+  std::size_t pos_{0};
+};
+
+}  // namespace spread_logic::detail
@@ -1,5 +1,11 @@
 #include "field.hpp"
 
+#include <algorithm>
+#include <array>
+
+#include "tile_pool.hpp"
+#include "wave_kernel.hpp"
+
 namespace spread_logic {
 
 bool Cell::IsFilled() const {
@@ -16,140 +22,562 @@ bool Cell::AddDot() {
 }
 
 // Field implementations
-Field::Field(std::size_t player_count, std::uint8_t width, std::uint8_t height)
-    : width_(width),
-      height_(height),
-      player_scores_(player_count + 1, 0) {
-  Fill();
-}
-
-std::size_t Field::SpreadStep() {
-  auto count = spread_queue_.size();
-  for (std::uint8_t i = 0; i < count; ++i) {
-    auto index = spread_queue_.front();
-    spread_queue_.pop();
-    auto& cell = cells_[index];
-
-    for (auto direction : Sides::kTraverse) {
-      auto neighbor_pos = MoveTo(cell.position, direction);
-      if (auto neighbor_index = GetIndex(neighbor_pos)) {
-        auto& neighbor = cells_[*neighbor_index];
-        ChangeOwner(neighbor, cell.owner_index);
-        if (neighbor.AddDot()) {
-          spread_queue_.push(*neighbor_index);
+template <class Board, class Rules>
+BasicField<Board, Rules>::BasicField(std::size_t player_count,
+                                     std::uint32_t width, std::uint32_t height)
+    : BasicField(player_count, Board(width, height)) {
+}
+
+template <class Board, class Rules>
+BasicField<Board, Rules>::BasicField(std::size_t player_count,
+                                     std::shared_ptr<const Topology> topology)
+  requires std::is_same_v<Board, DynamicBoard>
+    : BasicField(player_count, DynamicBoard(std::move(topology))) {
+}
+
+template <class Board, class Rules>
+BasicField<Board, Rules>::BasicField(std::size_t player_count, Board board)
+    : board_(std::move(board)),
+      player_count_(player_count),
+      player_scores_(
+          Board::template MakePlayerArray<std::uint64_t>(player_count)),
+      owned_cells_(
+          Board::template MakePlayerArray<std::uint32_t>(player_count)),
+      fullness_(board_.template MakeCellArray<std::uint8_t>()),
+      owner_(board_.template MakeCellArray<std::uint8_t>()) {
+  owned_cells_[0] = static_cast<std::uint32_t>(GetCellCount());
+}
+
+template <class Board, class Rules>
+template <class Fn>
+void BasicField<Board, Rules>::ForEachNeighbor(std::uint32_t index,
+                                               Fn&& fn) const {
+  if (const auto* neighbors = board_.GetNeighbors(); neighbors != nullptr) {
+    const auto* offsets = board_.GetNeighborOffsets();
+    for (auto k = offsets[index]; k < offsets[index + 1]; ++k) {
+      fn(neighbors[k]);
+    }
+    return;
+  }
+  auto config = board_.GetConfiguration()[index];
+  if ((config & Sides::TOP) != 0) {
+    fn(index - board_.GetWidth());
+  }
+  if ((config & Sides::RIGHT) != 0) {
+    fn(index + 1);
+  }
+  if ((config & Sides::BOTTOM) != 0) {
+    fn(index + board_.GetWidth());
+  }
+  if ((config & Sides::LEFT) != 0) {
+    fn(index - 1);
+  }
+}
+
+template <class Board, class Rules>
+std::size_t BasicField<Board, Rules>::SpreadStep() {
+  if (spread_queue_.empty()) {
+    return 0;
+  }
+  // Cells fire in index order so the result does not depend on the order in
+  // which they became overfull
+  std::sort(spread_queue_.begin(), spread_queue_.end());
+  wave_.swap(spread_queue_);
+  spread_queue_.clear();
+  if (journal_enabled_) {
+    ++journal_wave_;
+    BeginJournalWave();
+  }
+
+  for (auto index : wave_) {
+    auto owner = owner_[index];
+    auto capacity = board_.GetCapacity()[index];
+    if (journal_enabled_) {
+      RecordChange(index);
+    }
+    ForEachNeighbor(index, [this, owner](std::uint32_t neighbor) {
+      if constexpr (!Rules::kCaptureEnemies) {
+        // The dot aimed at an enemy cell leaves the board
+        if (owner_[neighbor] != 0 && owner_[neighbor] != owner) {
+          --player_scores_[owner];
+          return;
         }
       }
-    }
+      if (journal_enabled_) {
+        RecordChange(neighbor);
+      }
+      auto key = CellKey(neighbor);
+      ChangeOwner(neighbor, owner);
+      auto filled = AddDot(neighbor);
+      hash_ ^= key ^ CellKey(neighbor);
+      if (filled) {
+        spread_queue_.push_back(neighbor);
+      }
+    });
     // Clear the cell after spreading
-    cell.fullness -= cell.capacity;
-    if (cell.IsFilled()) {
-      spread_queue_.push(index);
-    } else if (cell.fullness == 0) {
-      cell.owner_index = 0;
+    auto key = CellKey(index);
+    fullness_[index] -= capacity;
+    if (fullness_[index] >= capacity) {
+      spread_queue_.push_back(index);
+    } else if (fullness_[index] == 0) {
+      TransferCell(owner_[index], 0);
+      owner_[index] = 0;
+    }
+    hash_ ^= key ^ CellKey(index);
+  }
+  if (journal_enabled_) {
+    EndJournalWave();
+  }
+  return wave_.size();
+}
+
+template <class Board, class Rules>
+std::size_t BasicField<Board, Rules>::StencilSpreadStep() {
+  if (spread_queue_.empty()) {
+    return 0;
+  }
+  // The kernels capture every cell a dot lands on
+  if constexpr (!Rules::kCaptureEnemies) {
+    return SpreadStep();
+  }
+  // and assume four sides and no wrap-around
+  if (!board_.IsGrid()) {
+    return SpreadStep();
+  }
+
+  auto cell_count = GetCellCount();
+  std::size_t guard = board_.GetWidth() + 1;
+  if (ready_.empty()) {
+    ready_.assign(cell_count + 2 * guard, 0);
+    fired_owner_.assign(cell_count + 2 * guard, 0);
+  }
+
+  detail::WaveGrid grid{board_.GetWidth(),
+                        cell_count,
+                        board_.GetCapacity(),
+                        board_.GetConfiguration(),
+                        fullness_.data(),
+                        owner_.data(),
+                        ready_.data() + guard,
+                        fired_owner_.data() + guard,
+                        player_scores_.data(),
+                        owned_cells_.data(),
+                        &eliminated_};
+  const auto& kernel = detail::GetWaveKernel();
+
+  // The kernel lists changed cells in index order, which is the journal
+  // order. Without a journal they only feed the hash.
+  std::size_t change_count = 0;
+  auto journal_begin = journal_.size();
+  if (journal_enabled_) {
+    ++journal_wave_;
+    journal_.resize(journal_begin + cell_count);
+    grid.journal = journal_.data() + journal_begin;
+    grid.journal_wave = journal_wave_;
+  } else {
+    wave_changes_.resize(cell_count);
+    grid.journal = wave_changes_.data();
+  }
+  grid.journal_size = &change_count;
+
+  std::sort(spread_queue_.begin(), spread_queue_.end());
+  wave_.resize(cell_count);
+  std::size_t count = 0;
+  if (auto tile_count = WaveTileCount(); tile_count > 1) {
+    count = TiledWave(grid, tile_count, change_count);
+  } else {
+    count = kernel.mark_ready(grid);
+    ResolveFiredOwners();
+    wave_.resize(kernel.apply_wave(grid, wave_.data()));
+  }
+  spread_queue_.swap(wave_);
+  for (std::size_t i = 0; i < change_count; ++i) {
+    const auto& c = grid.journal[i];
+    hash_ ^= ZobristKey(c.cell_idx, c.old_owner, c.old_fullness) ^
+             ZobristKey(c.cell_idx, c.new_owner, c.new_fullness);
+    if constexpr (kMoveStatsEnabled) {
+      owner_flips_ += c.old_owner != 0 && c.new_owner != 0 &&
+                      c.old_owner != c.new_owner;
     }
   }
+  if (journal_enabled_) {
+    journal_.resize(journal_begin + change_count);
+  }
   return count;
 }
 
-std::vector<std::size_t>& Field::GetPlayerScores() {
-  return player_scores_;
+template <class Board, class Rules>
+std::size_t BasicField<Board, Rules>::WaveTileCount() const {
+  auto cell_count = GetCellCount();
+  if (wave_threads_ < 2 || cell_count < kTiledMinCells) {
+    return 1;
+  }
+  // Independent of the machine, a pool with fewer threads runs the extra
+  // tiles one after another
+  return std::min({wave_threads_, cell_count / kMinTileCells, kMaxWaveTiles,
+                   static_cast<std::size_t>(board_.GetHeight())});
+}
+
+template <class Board, class Rules>
+std::size_t BasicField<Board, Rules>::TiledWave(const detail::WaveGrid& grid,
+                                                std::size_t tile_count,
+                                                std::size_t& change_count) {
+  // A wave is a gather: each cell reads the ready and fired-owner marks of
+  // its neighbors and writes only itself. Those marks are complete before
+  // the apply step, so the neighbor rows of a tile serve as its halo and the
+  // tiles only need their own counters and output slices.
+  const auto& kernel = detail::GetWaveKernel();
+  auto& pool = detail::TilePool::Get();
+  auto width = board_.GetWidth();
+  auto cell_count = GetCellCount();
+  auto players = player_count_ + 1;
+  auto tile_rows = (board_.GetHeight() + tile_count - 1) / tile_count;
+
+  tile_scores_.assign(tile_count * players, 0);
+  tile_owned_cells_.assign(tile_count * players, 0);
+  std::array<detail::WaveGrid, kMaxWaveTiles> tiles;
+  std::array<std::uint64_t, kMaxWaveTiles> tile_eliminated{};
+  std::array<std::size_t, kMaxWaveTiles> tile_changes{};
+  std::array<std::size_t, kMaxWaveTiles> tile_fired{};
+  std::array<std::size_t, kMaxWaveTiles> tile_next{};
+  for (std::size_t t = 0; t < tile_count; ++t) {
+    auto begin = std::min(t * tile_rows * width, cell_count);
+    auto end = std::min(begin + tile_rows * width, cell_count);
+    auto& tile = tiles[t];
+    tile = grid;
+    tile.cell_count = end - begin;
+    tile.capacity += begin;
+    tile.configuration += begin;
+    tile.fullness += begin;
+    tile.owner += begin;
+    tile.ready += begin;
+    tile.fired_owner += begin;
+    tile.scores = tile_scores_.data() + t * players;
+    tile.owned_cells = tile_owned_cells_.data() + t * players;
+    tile.eliminated = &tile_eliminated[t];
+    tile.journal += begin;
+    tile.journal_size = &tile_changes[t];
+    tile.first_cell = begin;
+  }
+
+  pool.Run(tile_count,
+           [&](std::size_t t) { tile_fired[t] = kernel.mark_ready(tiles[t]); });
+  // Serial: a fired owner follows chains of firing cells across tiles
+  ResolveFiredOwners();
+  pool.Run(tile_count, [&](std::size_t t) {
+    tile_next[t] = kernel.apply_wave(
+        tiles[t], wave_.data() + tiles[t].first_cell);
+  });
+
+  // Tiles wrote their changes and next cells at their own offsets, both in
+  // index order; packing them in tile order gives the serial lists
+  auto before = owned_cells_;
+  std::size_t fired = 0;
+  std::size_t next_count = 0;
+  for (std::size_t t = 0; t < tile_count; ++t) {
+    const auto& tile = tiles[t];
+    for (std::size_t p = 0; p < players; ++p) {
+      player_scores_[p] += tile.scores[p];
+      owned_cells_[p] += tile.owned_cells[p];
+    }
+    std::copy_n(tile.journal, tile_changes[t], grid.journal + change_count);
+    change_count += tile_changes[t];
+    std::copy_n(wave_.data() + tile.first_cell, tile_next[t],
+                wave_.data() + next_count);
+    next_count += tile_next[t];
+    fired += tile_fired[t];
+  }
+  wave_.resize(next_count);
+
+  // The deltas lose the moments an owner ran out mid-wave and regained a
+  // cell; TakeEliminated drops those anyway
+  for (std::size_t p = 1; p < players; ++p) {
+    if (before[p] != 0 && owned_cells_[p] == 0) {
+      eliminated_ |= PlayerBit(p);
+    }
+  }
+  return fired;
+}
+
+template <class Board, class Rules>
+void BasicField<Board, Rules>::ResolveFiredOwners() {
+  // A cell fires with the owner written by the last lower-indexed neighbor
+  // that fired before it: the left one if it fired, otherwise the top one
+  auto width = board_.GetWidth();
+  const auto* configuration = board_.GetConfiguration();
+  std::size_t guard = width + 1;
+  for (auto index : spread_queue_) {
+    const auto* ready = ready_.data() + guard + index;
+    auto* fired = fired_owner_.data() + guard + index;
+    if ((configuration[index] & Sides::LEFT) != 0 && *(ready - 1) != 0) {
+      *fired = *(fired - 1);
+    } else if (*(ready - width) != 0) {
+      *fired = *(fired - width);
+    } else {
+      *fired = owner_[index];
+    }
+  }
+}
+
+template <class Board, class Rules>
+PlayerMask BasicField<Board, Rules>::TakeEliminated() {
+  auto eliminated = eliminated_;
+  eliminated_ = 0;
+  // A player may have claimed a neutral cell again since the event
+  for (auto mask = eliminated; mask != 0; mask &= mask - 1) {
+    auto player_index = static_cast<std::size_t>(__builtin_ctzll(mask)) + 1;
+    if (owned_cells_[player_index] != 0) {
+      eliminated &= ~PlayerBit(player_index);
+    }
+  }
+  return eliminated;
+}
+
+template <class Board, class Rules>
+std::uint64_t BasicField<Board, Rules>::ZobristKey(std::uint32_t cell_idx,
+                                                   std::uint8_t owner,
+                                                   std::uint8_t fullness) {
+  if (fullness == 0) {
+    return 0;
+  }
+  // splitmix64 of the packed cell state
+  std::uint64_t x = (static_cast<std::uint64_t>(cell_idx) << 16) |
+                    (static_cast<std::uint64_t>(owner) << 8) | fullness;
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
 }
 
-const std::vector<std::size_t>& Field::GetPlayerScores() const {
-  return player_scores_;
+template <class Board, class Rules>
+typename BasicField<Board, Rules>::CellsView
+BasicField<Board, Rules>::GetCells() const {
+  return CellsView(this);
 }
 
-const std::vector<Cell>& Field::GetCells() const {
-  return cells_;
+template <class Board, class Rules>
+Cell BasicField<Board, Rules>::GetCell(std::size_t index) const {
+  Cell cell(ToCoordinate(index), board_.GetConfiguration()[index],
+            board_.GetCapacity()[index]);
+  cell.fullness = fullness_[index];
+  cell.owner_index = owner_[index];
+  return cell;
 }
 
-bool Field::PlaceDot(std::size_t player_index, std::size_t cell_idx) {
-  if (cell_idx >= cells_.size()) {
+template <class Board, class Rules>
+bool BasicField<Board, Rules>::PlaceDot(std::size_t player_index,
+                                        std::size_t cell_idx) {
+  if (cell_idx >= GetCellCount() || board_.GetCapacity()[cell_idx] == 0) {
     return false;
   }
-  auto& cell = cells_[cell_idx];
-  if (cell.IsOwned() && cell.owner_index != player_index) {
+  if (owner_[cell_idx] != 0 && owner_[cell_idx] != player_index) {
     return false;  // cannot place on enemy owned cell
   }
+  if (journal_enabled_) {
+    journal_.clear();
+    journal_wave_ = 0;
+    BeginJournalWave();
+    RecordChange(static_cast<std::uint32_t>(cell_idx));
+  }
+  auto index = static_cast<std::uint32_t>(cell_idx);
+  auto key = CellKey(index);
   // claim ownership if neutral
-  player_scores_[player_index]++;
-  cell.owner_index = static_cast<std::uint8_t>(player_index);
-  if (cell.AddDot()) {
-    spread_queue_.push(cell_idx);
+  player_scores_[player_index] += Rules::kDotsPerMove;
+  if (owner_[cell_idx] == 0) {
+    TransferCell(0, static_cast<std::uint8_t>(player_index));
+  }
+  owner_[cell_idx] = static_cast<std::uint8_t>(player_index);
+  // Only the dot reaching the capacity queues the cell
+  for (std::uint8_t dot = 0; dot < Rules::kDotsPerMove; ++dot) {
+    if (AddDot(cell_idx)) {
+      spread_queue_.push_back(index);
+    }
+  }
+  hash_ ^= key ^ CellKey(index);
+  if (journal_enabled_) {
+    EndJournalWave();
   }
 
   return true;
 }
 
-void Field::Fill() {
-  cells_.reserve(width_ * height_);
-  for (std::int8_t y = 0; y < static_cast<std::int8_t>(height_); ++y) {
-    for (std::int8_t x = 0; x < static_cast<std::int8_t>(width_); ++x) {
-      auto pos = Coordinate{x, y};
-      auto config = CalcConfiguration(pos);
-      cells_.emplace_back(pos, config,
-                          static_cast<std::uint8_t>(__builtin_popcount(
-                              static_cast<unsigned>(config))));
-    }
-  }
+template <class Board, class Rules>
+CellSet BasicField<Board, Rules>::LegalMoves(std::size_t player_index) const {
+  CellSet moves;
+  LegalMoves(player_index, moves);
+  return moves;
 }
 
-std::uint8_t Field::CalcConfiguration(Coordinate pos) const {
-  std::uint8_t config = 0;
-  if (pos.y > 0) {
-    config |= Sides::TOP;
-  }
-  if (pos.x < static_cast<std::int8_t>(width_ - 1)) {
-    config |= Sides::RIGHT;
+template <class Board, class Rules>
+void BasicField<Board, Rules>::LegalMoves(std::size_t player_index,
+                                          CellSet& moves) const {
+  auto cell_count = GetCellCount();
+  if (moves.GetCellCount() != cell_count) {
+    moves.Reset(cell_count);
   }
-  if (pos.y < static_cast<std::int8_t>(height_ - 1)) {
-    config |= Sides::BOTTOM;
-  }
-  if (pos.x > 0) {
-    config |= Sides::LEFT;
+  auto words = moves.GetWords();
+  detail::GetWaveKernel().legal_moves(owner_.data(), cell_count,
+                                      static_cast<std::uint8_t>(player_index),
+                                      words.data());
+  if (const auto* blocked = board_.GetBlocked(); blocked != nullptr) {
+    for (std::size_t i = 0; i < words.size(); ++i) {
+      words[i] &= ~blocked[i];
+    }
   }
-  return config;
 }
 
-std::size_t Field::ToIndex(Coordinate pos) const {
-  return static_cast<std::size_t>(pos.y * width_ + pos.x);
+template <class Board, class Rules>
+void BasicField<Board, Rules>::SetCell(std::size_t index, std::uint8_t owner,
+                                       std::uint8_t fullness) {
+  auto old_owner = owner_[index];
+  auto old_fullness = fullness_[index];
+  auto capacity = board_.GetCapacity()[index];
+  auto key = CellKey(static_cast<std::uint32_t>(index));
+
+  player_scores_[old_owner] -= old_fullness;
+  player_scores_[owner] += fullness;
+  --owned_cells_[old_owner];
+  ++owned_cells_[owner];
+  owner_[index] = owner;
+  fullness_[index] = fullness;
+  hash_ ^= key ^ CellKey(static_cast<std::uint32_t>(index));
+
+  if (fullness >= capacity && old_fullness < capacity) {
+    spread_queue_.push_back(static_cast<std::uint32_t>(index));
+  } else if (fullness < capacity && old_fullness >= capacity) {
+    auto end = std::remove(spread_queue_.begin(), spread_queue_.end(),
+                           static_cast<std::uint32_t>(index));
+    spread_queue_.resize(
+        static_cast<std::size_t>(end - spread_queue_.begin()));
+  }
 }
 
-Coordinate Field::ToCoordinate(std::size_t index) const {
-  return Coordinate{static_cast<std::int8_t>(index % width_),
-                    static_cast<std::int8_t>(index / width_)};
+template <class Board, class Rules>
+void BasicField<Board, Rules>::EnableJournal(bool enabled) {
+  journal_enabled_ = enabled;
+  journal_.clear();
+  if (enabled && journal_stamp_.empty()) {
+    journal_stamp_.assign(GetCellCount(), 0);
+    journal_.reserve(GetCellCount());
+  }
 }
 
-Coordinate Field::MoveTo(Coordinate pos, std::uint8_t direction) const {
-  if ((direction & Sides::TOP) != 0) {
-    pos.y--;
+template <class Board, class Rules>
+void BasicField<Board, Rules>::RevertMove(ChangeSet changes,
+                                          const UndoMark& mark) {
+  for (auto it = changes.rbegin(); it != changes.rend(); ++it) {
+    player_scores_[it->new_owner] -= it->new_fullness;
+    player_scores_[it->old_owner] += it->old_fullness;
+    if (it->new_owner != it->old_owner) {
+      --owned_cells_[it->new_owner];
+      ++owned_cells_[it->old_owner];
+    }
+    fullness_[it->cell_idx] = it->old_fullness;
+    owner_[it->cell_idx] = it->old_owner;
+    hash_ ^= ZobristKey(it->cell_idx, it->new_owner, it->new_fullness) ^
+             ZobristKey(it->cell_idx, it->old_owner, it->old_fullness);
   }
-  if ((direction & Sides::RIGHT) != 0) {
-    pos.x++;
+  eliminated_ = mark.eliminated;
+  spread_queue_.clear();
+  journal_.clear();
+}
+
+template <class Board, class Rules>
+void BasicField<Board, Rules>::BeginJournalWave() {
+  if (++journal_epoch_ == 0) {
+    // Stamps of old epochs could collide after wrapping around
+    std::fill(journal_stamp_.begin(), journal_stamp_.end(), 0);
+    journal_epoch_ = 1;
   }
-  if ((direction & Sides::BOTTOM) != 0) {
-    pos.y++;
+  journal_wave_begin_ = journal_.size();
+}
+
+template <class Board, class Rules>
+void BasicField<Board, Rules>::RecordChange(std::uint32_t index) {
+  if (journal_stamp_[index] == journal_epoch_) {
+    return;
   }
-  if ((direction & Sides::LEFT) != 0) {
-    pos.x--;
+  journal_stamp_[index] = journal_epoch_;
+  journal_.push_back(CellChange{index, journal_wave_, owner_[index],
+                                owner_[index], fullness_[index],
+                                fullness_[index]});
+}
+
+template <class Board, class Rules>
+void BasicField<Board, Rules>::EndJournalWave() {
+  auto begin =
+      journal_.begin() + static_cast<std::ptrdiff_t>(journal_wave_begin_);
+  for (auto it = begin; it != journal_.end(); ++it) {
+    it->new_owner = owner_[it->cell_idx];
+    it->new_fullness = fullness_[it->cell_idx];
   }
-  return pos;
+  // Drop cells that ended the wave as they started it
+  auto end =
+      std::remove_if(begin, journal_.end(), [](const CellChange& change) {
+        return change.old_owner == change.new_owner &&
+               change.old_fullness == change.new_fullness;
+      });
+  journal_.erase(end, journal_.end());
+  std::sort(begin, journal_.end(),
+            [](const CellChange& lhs, const CellChange& rhs) {
+              return lhs.cell_idx < rhs.cell_idx;
+            });
+}
+
+template <class Board, class Rules>
+std::size_t BasicField<Board, Rules>::ToIndex(Coordinate pos) const {
+  return static_cast<std::size_t>(pos.y) * board_.GetWidth() +
+         static_cast<std::size_t>(pos.x);
 }
 
-std::optional<std::size_t> Field::GetIndex(Coordinate pos) const {
-  if (pos.x >= 0 && pos.x < static_cast<std::int32_t>(width_) && pos.y >= 0 &&
-      pos.y < static_cast<std::int32_t>(height_)) {
+template <class Board, class Rules>
+Coordinate BasicField<Board, Rules>::ToCoordinate(std::size_t index) const {
+  return Coordinate{static_cast<std::int32_t>(index % board_.GetWidth()),
+                    static_cast<std::int32_t>(index / board_.GetWidth())};
+}
+
+template <class Board, class Rules>
+std::optional<std::size_t> BasicField<Board, Rules>::GetIndex(
+    Coordinate pos) const {
+  if (pos.x >= 0 && pos.x < static_cast<std::int32_t>(GetWidth()) &&
+      pos.y >= 0 && pos.y < static_cast<std::int32_t>(GetHeight())) {
     return ToIndex(pos);
   }
   return std::nullopt;
 }
 
-void Field::ChangeOwner(Cell& cell, std::uint8_t new_owner) {
-  if (cell.owner_index != 0) {
-    player_scores_[cell.owner_index] -= cell.fullness;
+template <class Board, class Rules>
+void BasicField<Board, Rules>::ChangeOwner(std::size_t index,
+                                           std::uint8_t new_owner) {
+  auto old_owner = owner_[index];
+  if (old_owner == new_owner) {
+    return;
+  }
+  auto fullness = fullness_[index];
+  if (old_owner != 0) {
+    player_scores_[old_owner] -= fullness;
+    if constexpr (kMoveStatsEnabled) {
+      ++owner_flips_;
+    }
+  }
+  player_scores_[new_owner] += fullness;
+  owner_[index] = new_owner;
+  TransferCell(old_owner, new_owner);
+}
+
+template <class Board, class Rules>
+void BasicField<Board, Rules>::TransferCell(std::uint8_t from,
+                                            std::uint8_t to) {
+  ++owned_cells_[to];
+  if (--owned_cells_[from] == 0 && from != 0) {
+    eliminated_ |= PlayerBit(from);
   }
-  player_scores_[new_owner] += cell.fullness;
-  cell.owner_index = new_owner;
+}
+
+template <class Board, class Rules>
+bool BasicField<Board, Rules>::AddDot(std::size_t index) {
+  // Cells that were already overfull are queued already
+  return ++fullness_[index] == board_.GetCapacity()[index];
 }
 
 #ifdef SPREAD_LOGIC_ENABLE_JSON
@@ -163,11 +591,19 @@ void to_json(::nlohmann::json& j, const Cell& cell) {
                        {"owner_index", cell.owner_index}};
 }
 
-void to_json(::nlohmann::json& j, const Field& field) {
+template <class Board, class Rules>
+void to_json(::nlohmann::json& j, const BasicField<Board, Rules>& field) {
+  auto cells = ::nlohmann::json::array();
+  cells.get_ref<::nlohmann::json::array_t&>().reserve(field.GetCellCount());
+  for (auto cell : field.GetCells()) {
+    cells.push_back(cell);
+  }
   j = ::nlohmann::json{{"width", field.GetWidth()},
                        {"height", field.GetHeight()},
-                       {"cells", field.GetCells()},
-                       {"scores", field.GetPlayerScores()}};
+                       {"cells", std::move(cells)},
+                       {"scores", std::vector<std::uint64_t>(
+                                      field.GetPlayerScores().begin(),
+                                      field.GetPlayerScores().end())}};
 }
 
 void from_json(const ::nlohmann::json& j, Cell& cell) {
@@ -179,6 +615,29 @@ void from_json(const ::nlohmann::json& j, Cell& cell) {
   j.at("owner_index").get_to(cell.owner_index);
 }
 
+template void to_json(::nlohmann::json& j,
+                      const BasicField<DynamicBoard>& field);
+#define SPREAD_LOGIC_INSTANTIATE_TO_JSON(width, height) \
+  template void to_json(::nlohmann::json& j,             \
+                        const BasicField<FixedBoard<width, height>>& field);
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_INSTANTIATE_TO_JSON)
+#undef SPREAD_LOGIC_INSTANTIATE_TO_JSON
+#define SPREAD_LOGIC_INSTANTIATE_VARIANT_TO_JSON(capture, dots) \
+  template void to_json(::nlohmann::json& j,                    \
+                        const VariantField<capture, dots>& field);
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_INSTANTIATE_VARIANT_TO_JSON)
+#undef SPREAD_LOGIC_INSTANTIATE_VARIANT_TO_JSON
+
 #endif
 
+template class BasicField<DynamicBoard>;
+#define SPREAD_LOGIC_INSTANTIATE_FIELD(width, height) \
+  template class BasicField<FixedBoard<width, height>>;
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_INSTANTIATE_FIELD)
+#undef SPREAD_LOGIC_INSTANTIATE_FIELD
+#define SPREAD_LOGIC_INSTANTIATE_VARIANT_FIELD(capture, dots) \
+  template class BasicField<DynamicBoard, SpreadRules<capture, dots>>;
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_INSTANTIATE_VARIANT_FIELD)
+#undef SPREAD_LOGIC_INSTANTIATE_VARIANT_FIELD
+
 }  // namespace spread_logic
@@ -0,0 +1,213 @@
+#include "field_codec.hpp"
+
+#include <algorithm>
+
+#include "byte_io.hpp"
+
+namespace spread_logic {
+
+namespace {
+
+using detail::ByteReader;
+using detail::WriteVarint;
+
+constexpr std::uint8_t kRunLengthFlag = 1;
+constexpr std::uint8_t kEscapeNibble = 0xF;
+constexpr std::uint8_t kEscapedCell = 0xF0;
+constexpr std::uint8_t kEmptyRun = 0xF1;
+// Shorter runs are cheaper as single empty-cell bytes
+constexpr std::size_t kMinRun = 3;
+
+struct Header {
+  FieldHeader field;
+  bool run_length;
+};
+
+Header ReadHeader(ByteReader& reader) {
+  if (reader.Byte() != kFieldEncodingVersion) {
+    throw errors::kInvalidFieldEncoding;
+  }
+  auto flags = reader.Byte();
+  if ((flags & ~kRunLengthFlag) != 0) {
+    throw errors::kInvalidFieldEncoding;
+  }
+  auto width = reader.Varint();
+  auto height = reader.Varint();
+  std::size_t player_count = reader.Byte();
+  if (width > UINT32_MAX || height > UINT32_MAX ||
+      player_count > kMaxPlayers) {
+    throw errors::kInvalidFieldEncoding;
+  }
+  return Header{{static_cast<std::uint32_t>(width),
+                 static_cast<std::uint32_t>(height), player_count},
+                (flags & kRunLengthFlag) != 0};
+}
+
+std::vector<std::uint64_t> ReadScores(ByteReader& reader,
+                                      const Header& header) {
+  std::vector<std::uint64_t> scores(header.field.player_count + 1, 0);
+  for (std::size_t player = 1; player < scores.size(); ++player) {
+    scores[player] = reader.Varint();
+  }
+  return scores;
+}
+
+// Walk the cell stream up to the end of the data, calling
+// cells(begin, end, owner, fullness) for every run of equal cells. Checks the
+// structure only, so it also runs before a field exists.
+template <class Cells>
+void ReadCells(ByteReader& reader, const Header& header,
+               std::uint64_t cell_count, Cells&& cells) {
+  for (std::uint64_t index = 0; index < cell_count;) {
+    auto byte = reader.Byte();
+    std::uint8_t owner = byte >> 4;
+    std::uint8_t fullness = byte & 0xF;
+    if (owner == kEscapeNibble) {
+      if (byte == kEmptyRun && header.run_length) {
+        auto run = reader.Varint();
+        if (run == 0 || run > cell_count - index) {
+          throw errors::kInvalidFieldEncoding;
+        }
+        cells(index, index + run, 0, 0);
+        index += run;
+        continue;
+      }
+      if (byte != kEscapedCell) {
+        throw errors::kInvalidFieldEncoding;
+      }
+      owner = reader.Byte();
+      fullness = reader.Byte();
+    }
+    if (owner > header.field.player_count || (fullness == 0) != (owner == 0)) {
+      throw errors::kInvalidFieldEncoding;
+    }
+    cells(index, index + 1, owner, fullness);
+    ++index;
+  }
+  if (!reader.AtEnd()) {
+    throw errors::kInvalidFieldEncoding;
+  }
+}
+
+}  // namespace
+
+template <class Board, class Rules>
+std::vector<std::uint8_t> EncodeField(const BasicField<Board, Rules>& field,
+                                      bool run_length) {
+  std::vector<std::uint8_t> out;
+  auto cell_count = field.GetCellCount();
+  out.reserve(16 + 2 * field.GetPlayerCount() + cell_count);
+  out.push_back(kFieldEncodingVersion);
+  out.push_back(run_length ? kRunLengthFlag : 0);
+  WriteVarint(out, field.GetWidth());
+  WriteVarint(out, field.GetHeight());
+  out.push_back(static_cast<std::uint8_t>(field.GetPlayerCount()));
+  auto scores = field.GetPlayerScores();
+  for (std::size_t player = 1; player < scores.size(); ++player) {
+    WriteVarint(out, scores[player]);
+  }
+
+  for (std::size_t index = 0; index < cell_count;) {
+    auto owner = field.GetOwner(index);
+    auto fullness = field.GetFullness(index);
+    if (run_length && fullness == 0) {
+      auto end = index + 1;
+      while (end < cell_count && field.GetFullness(end) == 0) {
+        ++end;
+      }
+      if (end - index >= kMinRun) {
+        out.push_back(kEmptyRun);
+        WriteVarint(out, end - index);
+        index = end;
+        continue;
+      }
+    }
+    if (owner < kEscapeNibble && fullness <= 0xF) {
+      out.push_back(static_cast<std::uint8_t>((owner << 4) | fullness));
+    } else {
+      out.push_back(kEscapedCell);
+      out.push_back(owner);
+      out.push_back(fullness);
+    }
+    ++index;
+  }
+  return out;
+}
+
+FieldHeader ReadFieldHeader(std::span<const std::uint8_t> data) {
+  ByteReader reader(data, errors::kInvalidFieldEncoding);
+  auto header = ReadHeader(reader);
+  ReadScores(reader, header);
+  std::uint64_t cell_count =
+      std::uint64_t{header.field.width} * header.field.height;
+  ReadCells(reader, header, cell_count,
+            [](std::uint64_t, std::uint64_t, std::uint8_t, std::uint8_t) {});
+  return header.field;
+}
+
+template <class Board, class Rules>
+void DecodeField(std::span<const std::uint8_t> data,
+                 BasicField<Board, Rules>& field, bool allow_overfull) {
+  ByteReader reader(data, errors::kInvalidFieldEncoding);
+  auto header = ReadHeader(reader);
+  if (header.field.width != field.GetWidth() ||
+      header.field.height != field.GetHeight() ||
+      header.field.player_count != field.GetPlayerCount()) {
+    throw errors::kInvalidFieldEncoding;
+  }
+  auto scores = ReadScores(reader, header);
+
+  ReadCells(reader, header, field.GetCellCount(),
+            [&field, allow_overfull](std::uint64_t begin, std::uint64_t end,
+                                     std::uint8_t owner,
+                                     std::uint8_t fullness) {
+              for (auto index = begin; index < end; ++index) {
+                // Blocked cells have capacity 0 and never take a dot
+                auto capacity = field.GetCapacity(index);
+                if (fullness != 0 &&
+                    (capacity == 0 ||
+                     (fullness >= capacity && !allow_overfull))) {
+                  throw errors::kInvalidFieldEncoding;
+                }
+                field.SetCell(index, owner, fullness);
+              }
+            });
+
+  // Set the cells first, they count their dots into the scores
+  auto field_scores = field.GetPlayerScores();
+  std::copy(scores.begin(), scores.end(), field_scores.begin());
+}
+
+Field DecodeField(std::span<const std::uint8_t> data) {
+  // Checks the cells against the header before the field is allocated
+  auto header = ReadFieldHeader(data);
+  if (!Field::IsValidSize(header.width, header.height)) {
+    throw errors::kInvalidFieldEncoding;
+  }
+  Field field(header.player_count, header.width, header.height);
+  DecodeField(data, field);
+  return field;
+}
+
+template std::vector<std::uint8_t> EncodeField(const Field& field,
+                                               bool run_length);
+template void DecodeField(std::span<const std::uint8_t> data, Field& field,
+                          bool allow_overfull);
+#define SPREAD_LOGIC_INSTANTIATE_CODEC(width, height)           \
+  template std::vector<std::uint8_t> EncodeField(               \
+      const FixedField<width, height>& field, bool run_length); \
+  template void DecodeField(std::span<const std::uint8_t> data, \
+                            FixedField<width, height>& field,   \
+                            bool allow_overfull);
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_INSTANTIATE_CODEC)
+#undef SPREAD_LOGIC_INSTANTIATE_CODEC
+#define SPREAD_LOGIC_INSTANTIATE_VARIANT_CODEC(capture, dots)     \
+  template std::vector<std::uint8_t> EncodeField(                 \
+      const VariantField<capture, dots>& field, bool run_length); \
+  template void DecodeField(std::span<const std::uint8_t> data,   \
+                            VariantField<capture, dots>& field,   \
+                            bool allow_overfull);
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_INSTANTIATE_VARIANT_CODEC)
+#undef SPREAD_LOGIC_INSTANTIATE_VARIANT_CODEC
+
+}  // namespace spread_logic
@@ -1,77 +1,353 @@
 #include "game.hpp"
 
-#include <numeric>
+#include <algorithm>
 #include <vector>
 
 namespace spread_logic {
 
-Game::Game(std::size_t player_count, std::uint8_t width, std::uint8_t height)
-    : field_(player_count, width, height),
-      alive_players_(player_count),
-      current_player_(alive_players_.begin()) {
-  std::iota(alive_players_.begin(), alive_players_.end(), 1);
+namespace {
+
+// Checked before the field allocates anything, return player_count
+std::size_t ValidatePlayers(std::size_t player_count) {
+  if (player_count > kMaxPlayers) {
+    throw errors::kTooManyPlayers;
+  }
+  return player_count;
+}
+
+template <class FieldType>
+std::size_t ValidateGame(std::size_t player_count, std::uint32_t width,
+                         std::uint32_t height) {
+  // A lone cell has no neighbors to spread to and would fire forever
+  if (!FieldType::IsValidSize(width, height)) {
+    throw errors::kInvalidBoardSize;
+  }
+  return ValidatePlayers(player_count);
+}
+
+}  // namespace
+
+template <class FieldType>
+BasicGame<FieldType>::BasicGame(std::size_t player_count, std::uint32_t width,
+                                std::uint32_t height, EngineOptions options)
+    : field_(ValidateGame<FieldType>(player_count, width, height), width,
+             height),
+      alive_players_(PlayerSet::FirstN(player_count)),
+      current_player_(alive_players_.empty() ? 0 : 1),
+      engine_(options.engine) {
+  field_.SetWaveThreads(options.wave_threads);
+  if (options.shadow) {
+    reference_.emplace(player_count, field_.GetTopology());
+  }
+}
+
+template <class FieldType>
+BasicGame<FieldType>::BasicGame(std::size_t player_count,
+                                std::shared_ptr<const Topology> topology,
+                                EngineOptions options)
+  requires std::is_same_v<typename FieldType::BoardType, DynamicBoard>
+    : field_(ValidatePlayers(player_count), std::move(topology)),
+      alive_players_(PlayerSet::FirstN(player_count)),
+      current_player_(alive_players_.empty() ? 0 : 1),
+      engine_(options.engine) {
+  field_.SetWaveThreads(options.wave_threads);
+  if (options.shadow) {
+    reference_.emplace(player_count, field_.GetTopology());
+  }
+}
+
+template <class FieldType>
+MoveStats BasicGame<FieldType>::MakeMove(std::size_t cell_idx) {
+  auto stats = PlayMove(cell_idx);
+  undo_frames_.clear();
+  undo_changes_.clear();
+  return stats;
+}
+
+template <class FieldType>
+MoveStats BasicGame<FieldType>::MakeMove(
+    BasicMoveSource<BasicGame>& source) {
+  return MakeMove(source.ChooseMove(*this));
+}
+
+template <class FieldType>
+MoveStats BasicGame<FieldType>::Apply(std::size_t cell_idx) {
+  if (!field_.IsJournalEnabled()) {
+    field_.EnableJournal(true);
+  }
+  UndoFrame frame{undo_changes_.size(), alive_players_, current_player_,
+                  turn_count_, field_.GetUndoMark()};
+  auto stats = PlayMove(cell_idx);
+  auto changes = field_.GetChanges();
+  undo_changes_.insert(undo_changes_.end(), changes.begin(), changes.end());
+  undo_frames_.push_back(frame);
+  return stats;
 }
 
-void Game::MakeMove(std::size_t cell_idx) {
+template <class FieldType>
+void BasicGame<FieldType>::Undo() {
+  if (undo_frames_.empty()) {
+    throw errors::kNothingToUndo;
+  }
+  auto frame = undo_frames_.back();
+  undo_frames_.pop_back();
+
+  field_.RevertMove(
+      ChangeSet(undo_changes_).subspan(frame.changes_begin), frame.field_mark);
+  if (reference_) {
+    SyncReference();
+  }
+  undo_changes_.resize(frame.changes_begin);
+  move_history_.pop_back();
+  turn_count_ = frame.turn_count;
+  alive_players_ = frame.alive;
+  current_player_ = frame.current_player;
+}
+
+template <class FieldType>
+MoveStats BasicGame<FieldType>::PlayMove(std::size_t cell_idx) {
   if (alive_players_.size() <= 1) {
     throw errors::kGameAlreadyOver;
   }
 
   // Try placing the dot
-  if (!field_.PlaceDot(*current_player_, cell_idx)) {
+  if (!field_.PlaceDot(current_player_, cell_idx)) {
     throw errors::kInvalidMove;
   }
+  if (reference_) {
+    // A disagreement shows up in CheckReference
+    reference_->PlaceDot(current_player_, cell_idx);
+  }
 
-  move_history_.emplace_back(Move{*current_player_, cell_idx});
+  move_history_.emplace_back(Move{current_player_, cell_idx});
 
   // Perform spreading chain reaction
-  while (field_.SpreadStep() != 0 && alive_players_.size() > 1) {
-    // Eliminate dead players
-    UpdateAliveness();
+  MoveStats stats;
+  auto alive = alive_players_;
+  auto flips = field_.GetOwnerFlips();
+  if (!RunCascade(stats)) {
+    ResolveEndlessCascade(move_history_.back().player_index);
+  }
+  if constexpr (kMoveStatsEnabled) {
+    stats.waves = static_cast<std::uint32_t>(last_cascade_waves_);
+    stats.owner_flips = field_.GetOwnerFlips() - flips;
+    stats.eliminated = alive.GetMask() & ~alive_players_.GetMask();
   }
 
   // Advance turn to next alive player
   NextTurn();
+
+  if (reference_) {
+    CheckReference();
+  }
+  return stats;
+}
+
+template <class FieldType>
+std::size_t BasicGame<FieldType>::SpreadStep() {
+  auto fired = engine_ == SpreadEngine::kStencil ? field_.StencilSpreadStep()
+                                                 : field_.SpreadStep();
+  if (reference_) {
+    reference_->SpreadStep();
+  }
+  return fired;
+}
+
+template <class FieldType>
+void BasicGame<FieldType>::CheckReference() const {
+  const auto& reference = *reference_;
+  auto cell_count = field_.GetCellCount();
+  for (std::size_t index = 0; index < cell_count; ++index) {
+    if (field_.GetOwner(index) != reference.GetOwner(index) ||
+        field_.GetFullness(index) != reference.GetFullness(index)) {
+      throw errors::kEngineMismatch;
+    }
+  }
+  auto scores = field_.GetPlayerScores();
+  auto owned = field_.GetOwnedCells();
+  if (!std::ranges::equal(scores, reference.GetPlayerScores()) ||
+      !std::ranges::equal(owned, reference.GetOwnedCells()) ||
+      field_.StateHash() != reference.StateHash()) {
+    throw errors::kEngineMismatch;
+  }
+}
+
+template <class FieldType>
+void BasicGame<FieldType>::SyncReference() {
+  auto& reference = *reference_;
+  auto cell_count = field_.GetCellCount();
+  for (std::size_t index = 0; index < cell_count; ++index) {
+    reference.SetCell(index, field_.GetOwner(index),
+                      field_.GetFullness(index));
+  }
+  // Scores last, SetCell counts the dots into them
+  auto scores = field_.GetPlayerScores();
+  std::ranges::copy(scores, reference.GetPlayerScores().begin());
+}
+
+template <class FieldType>
+bool BasicGame<FieldType>::RunCascade(MoveStats& stats) {
+  last_cascade_waves_ = 0;
+  auto cell_count = field_.GetCellCount();
+  auto max_waves = kMaxCascadeWavesPerCell * cell_count;
+  auto& waves = last_cascade_waves_;
+
+  // Brent's cycle detection over the incremental position hash
+  auto saved_hash = field_.StateHash();
+  std::size_t power = 1;
+  std::size_t since_saved = 0;
+
+  std::size_t fired = 0;
+  while ((fired = SpreadStep()) != 0) {
+    ++waves;
+    if constexpr (kMoveStatsEnabled) {
+      stats.cells_fired += fired;
+      stats.peak_queue = std::max(stats.peak_queue,
+                                  static_cast<std::uint32_t>(fired));
+    }
+    // The wave after the last elimination still runs and ends the cascade
+    if (alive_players_.size() <= 1) {
+      break;
+    }
+
+    // Eliminate dead players
+    UpdateAliveness();
+
+    if (waves >= max_waves) {
+      return false;
+    }
+    auto hash = field_.StateHash();
+    if (hash == saved_hash) {
+      return false;
+    }
+    if (++since_saved == power) {
+      saved_hash = hash;
+      power *= 2;
+      since_saved = 0;
+    }
+  }
+  return true;
 }
 
-void Game::NextTurn() {
+template <class FieldType>
+void BasicGame<FieldType>::ResolveEndlessCascade(std::size_t mover) {
+  const auto& scores = field_.GetPlayerScores();
+  auto winner =
+      alive_players_.Contains(mover) ? mover : alive_players_.front();
+  for (auto player_index : alive_players_) {
+    if (scores[player_index] > scores[winner]) {
+      winner = player_index;
+    }
+  }
+  alive_players_ = PlayerSet(PlayerBit(winner));
+  current_player_ = winner;
+}
+
+template <class FieldType>
+void BasicGame<FieldType>::NextTurn() {
   if (alive_players_.empty()) {
     return;
   }
   turn_count_++;
-  current_player_++;
-  if (current_player_ == alive_players_.end()) {
-    current_player_ = alive_players_.begin();
-  }
+  current_player_ = alive_players_.NextAfter(current_player_);
 }
 
-void Game::EliminatePlayer(std::size_t player_idx) {
+template <class FieldType>
+void BasicGame<FieldType>::EliminatePlayer(std::size_t player_idx) {
   field_.GetPlayerScores()[player_idx] = 0;
-
-  if (player_idx != *current_player_) {
-    std::erase(alive_players_, player_idx);
-    return;
+  if (reference_) {
+    reference_->GetPlayerScores()[player_idx] = 0;
   }
 
-  current_player_ = alive_players_.erase(current_player_);
-  if (current_player_ == alive_players_.end() && !alive_players_.empty()) {
-    current_player_ = alive_players_.begin();
+  alive_players_.Erase(player_idx);
+  if (player_idx == current_player_) {
+    current_player_ = alive_players_.NextAfter(player_idx);
   }
 }
 
-const std::list<std::size_t>& Game::GetAlivePlayers() const {
-  return alive_players_;
+template <class FieldType>
+std::uint64_t BasicGame<FieldType>::GetHash() const {
+  if (alive_players_.empty()) {
+    return field_.StateHash();
+  }
+  // Side to move, keyed far away from any cell key input
+  std::uint64_t x = ~static_cast<std::uint64_t>(GetCurrentPlayer());
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return field_.StateHash() ^ x ^ (x >> 31);
 }
 
-void Game::UpdateAliveness() {
+template <class FieldType>
+void BasicGame<FieldType>::UpdateAliveness() {
   if (turn_count_ < alive_players_.size()) {
     return;  // Don't update aliveness until all players had at least one turn
   }
 
-  const auto& scores = field_.GetPlayerScores();
-  std::erase_if(alive_players_, [&scores](std::size_t player_index) {
-    return scores[player_index] == 0;
-  });
+  // Events raised by the field while cells changed hands, so there is
+  // nothing to scan
+  auto eliminated = field_.TakeEliminated();
+  alive_players_ = PlayerSet(alive_players_.GetMask() & ~eliminated);
+}
+
+template class BasicGame<Field>;
+#define SPREAD_LOGIC_INSTANTIATE_GAME(width, height) \
+  template class BasicGame<FixedField<width, height>>;
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_INSTANTIATE_GAME)
+#undef SPREAD_LOGIC_INSTANTIATE_GAME
+#define SPREAD_LOGIC_INSTANTIATE_VARIANT_GAME(capture, dots) \
+  template class BasicGame<VariantField<capture, dots>>;
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_INSTANTIATE_VARIANT_GAME)
+#undef SPREAD_LOGIC_INSTANTIATE_VARIANT_GAME
+
+AnyGame MakeGame(std::size_t player_count, std::uint32_t width,
+                 std::uint32_t height, EngineOptions options) {
+#define SPREAD_LOGIC_MAKE_FIXED_GAME(fixed_width, fixed_height)             \
+  if (width == (fixed_width) && height == (fixed_height)) {                 \
+    using Fixed = FixedGame<fixed_width, fixed_height>;                     \
+    return AnyGame(std::in_place_type<Fixed>, player_count, width, height,  \
+                   options);                                                \
+  }
+  SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_MAKE_FIXED_GAME)
+#undef SPREAD_LOGIC_MAKE_FIXED_GAME
+  return AnyGame(std::in_place_type<Game>, player_count, width, height,
+                 options);
+}
+
+AnyGame MakeGame(std::size_t player_count,
+                 std::shared_ptr<const Topology> topology,
+                 EngineOptions options) {
+  if (topology->IsGrid()) {
+    return MakeGame(player_count, topology->GetWidth(), topology->GetHeight(),
+                    options);
+  }
+  return AnyGame(std::in_place_type<Game>, player_count, std::move(topology),
+                 options);
+}
+
+AnyGame MakeGame(std::size_t player_count,
+                 std::shared_ptr<const Topology> topology, RuleOptions rules,
+                 EngineOptions options) {
+  if (rules == ClassicRules::kOptions) {
+    return MakeGame(player_count, std::move(topology), options);
+  }
+#define SPREAD_LOGIC_MAKE_VARIANT_GAME(capture, dots)         \
+  if (rules == RuleOptions{capture, dots}) {                  \
+    using Variant = VariantGame<capture, dots>;               \
+    return AnyGame(std::in_place_type<Variant>, player_count, \
+                   std::move(topology), options);             \
+  }
+  SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_MAKE_VARIANT_GAME)
+#undef SPREAD_LOGIC_MAKE_VARIANT_GAME
+  throw errors::kUnsupportedRules;
+}
+
+bool HasEngine(RuleOptions rules) {
+#define SPREAD_LOGIC_IS_VARIANT(capture, dots) \
+  || rules == RuleOptions{capture, dots}
+  return rules == ClassicRules::kOptions SPREAD_LOGIC_RULE_VARIANTS(
+      SPREAD_LOGIC_IS_VARIANT);
+#undef SPREAD_LOGIC_IS_VARIANT
 }
 
 #ifdef SPREAD_LOGIC_ENABLE_JSON
@@ -0,0 +1,264 @@
+#include "game_codec.hpp"
+
+#include <string>
+#include <utility>
+
+#include "byte_io.hpp"
+
+namespace spread_logic {
+
+namespace {
+
+using detail::ByteReader;
+using detail::WriteVarint;
+
+void WriteBoard(std::vector<std::uint8_t>& out, RuleOptions rules,
+                const Topology& topology) {
+  out.push_back(rules.capture_enemies ? 1 : 0);
+  out.push_back(rules.dots_per_move);
+  out.push_back(static_cast<std::uint8_t>(topology.GetKind()));
+  auto cell_count = topology.GetCellCount();
+  if (topology.GetKind() == TopologyKind::kMap) {
+    std::uint8_t holes = 0;
+    for (std::size_t index = 0; index < cell_count; ++index) {
+      if (topology.IsBlocked(index)) {
+        holes |= static_cast<std::uint8_t>(1 << (index % 8));
+      }
+      if (index % 8 == 7 || index + 1 == cell_count) {
+        out.push_back(holes);
+        holes = 0;
+      }
+    }
+  } else if (topology.GetKind() == TopologyKind::kCustom) {
+    const auto* offsets = topology.GetNeighborOffsets();
+    const auto* neighbors = topology.GetNeighbors();
+    for (std::size_t index = 0; index < cell_count; ++index) {
+      WriteVarint(out, offsets[index + 1] - offsets[index]);
+      for (auto k = offsets[index]; k < offsets[index + 1]; ++k) {
+        WriteVarint(out, neighbors[k]);
+      }
+    }
+  }
+}
+
+// Board of the header, reading the map holes or neighbor lists that follow
+// it. Those take a bit or a byte of the data per cell at least, the generated
+// kinds read nothing and build a board of any size the header names.
+std::shared_ptr<const Topology> ReadTopology(ByteReader& reader,
+                                             const GameHeader& header) {
+  const auto& field = header.field;
+  auto width = field.width;
+  auto height = field.height;
+  auto cell_count = std::uint64_t{width} * height;
+  switch (header.topology_kind) {
+    case TopologyKind::kRectangle:
+      return Topology::Rectangle(width, height, errors::kInvalidGameEncoding);
+    case TopologyKind::kTorus:
+      return Topology::Torus(width, height, errors::kInvalidGameEncoding);
+    case TopologyKind::kHex:
+      return Topology::Hex(width, height, errors::kInvalidGameEncoding);
+    case TopologyKind::kMoore:
+      return Topology::Moore(width, height, errors::kInvalidGameEncoding);
+    case TopologyKind::kMap: {
+      auto holes = reader.Bytes((cell_count + 7) / 8);
+      std::string map;
+      map.reserve(cell_count + height);
+      for (std::uint64_t index = 0; index < cell_count; ++index) {
+        bool hole = ((holes[index / 8] >> (index % 8)) & 1) != 0;
+        map.push_back(hole ? '#' : '.');
+        if ((index + 1) % width == 0) {
+          map.push_back('\n');
+        }
+      }
+      return Topology::FromMap(map, errors::kInvalidGameEncoding);
+    }
+    case TopologyKind::kCustom: {
+      std::vector<std::uint32_t> offsets = {0};
+      std::vector<std::uint32_t> neighbors;
+      for (std::uint64_t index = 0; index < cell_count; ++index) {
+        auto degree = reader.Varint();
+        if (degree > Topology::kMaxDegree) {
+          throw errors::kInvalidGameEncoding;
+        }
+        for (std::uint64_t k = 0; k < degree; ++k) {
+          auto neighbor = reader.Varint();
+          if (neighbor >= cell_count) {
+            throw errors::kInvalidGameEncoding;
+          }
+          neighbors.push_back(static_cast<std::uint32_t>(neighbor));
+        }
+        offsets.push_back(static_cast<std::uint32_t>(neighbors.size()));
+      }
+      return Topology::FromNeighbors(width, height, std::move(offsets),
+                                     std::move(neighbors),
+                                     errors::kInvalidGameEncoding);
+    }
+  }
+  throw errors::kInvalidGameEncoding;
+}
+
+struct Header {
+  GameHeader game;
+  std::span<const std::uint8_t> field_data;
+};
+
+// Everything up to the topology kind, the board data follows
+Header ReadHeader(ByteReader& reader) {
+  if (reader.Byte() != kGameEncodingVersion) {
+    throw errors::kInvalidGameEncoding;
+  }
+  Header header;
+  header.field_data = reader.Bytes(reader.Varint());
+  header.game.field = ReadFieldHeader(header.field_data);
+  auto capture = reader.Byte();
+  auto dots = reader.Byte();
+  if (capture > 1 || dots == 0) {
+    throw errors::kInvalidGameEncoding;
+  }
+  header.game.rules = RuleOptions{capture == 1, dots};
+  auto kind = reader.Byte();
+  if (kind > static_cast<std::uint8_t>(TopologyKind::kCustom)) {
+    throw errors::kInvalidGameEncoding;
+  }
+  header.game.topology_kind = static_cast<TopologyKind>(kind);
+  return header;
+}
+
+// The board data of the header read and checked against the game
+void CheckTopology(ByteReader& reader, const GameHeader& header,
+                   const Topology& topology) {
+  // Sizes first, a bogus header must not get to allocate a board
+  if (header.topology_kind != topology.GetKind() ||
+      header.field.width != topology.GetWidth() ||
+      header.field.height != topology.GetHeight()) {
+    throw errors::kCheckpointMismatch;
+  }
+  // The generated kinds follow from the size
+  if (header.topology_kind == TopologyKind::kMap ||
+      header.topology_kind == TopologyKind::kCustom) {
+    if (*ReadTopology(reader, header) != topology) {
+      throw errors::kCheckpointMismatch;
+    }
+  }
+}
+
+}  // namespace
+
+template <class FieldType>
+std::vector<std::uint8_t> EncodeGame(const BasicGame<FieldType>& game) {
+  const auto& field = game.GetField();
+  auto field_data = EncodeField(field);
+  const auto& moves = game.GetMoveHistory();
+
+  std::vector<std::uint8_t> out;
+  out.reserve(48 + field_data.size() + 4 * moves.size());
+  out.push_back(kGameEncodingVersion);
+  WriteVarint(out, field_data.size());
+  out.insert(out.end(), field_data.begin(), field_data.end());
+  WriteBoard(out, game.GetRuleOptions(), *field.GetTopology());
+  WriteVarint(out, game.GetAlivePlayers().GetMask());
+  out.push_back(static_cast<std::uint8_t>(game.GetCurrentPlayer()));
+  WriteVarint(out, game.GetCurrentTurn());
+  WriteVarint(out, game.GetLastCascadeWaves());
+  WriteVarint(out, field.GetPendingEliminated());
+  WriteVarint(out, moves.size());
+  for (const auto& move : moves) {
+    out.push_back(static_cast<std::uint8_t>(move.player_index));
+    WriteVarint(out, move.cell_idx);
+  }
+  return out;
+}
+
+GameHeader ReadGameHeader(std::span<const std::uint8_t> data) {
+  ByteReader reader(data, errors::kInvalidGameEncoding);
+  return ReadHeader(reader).game;
+}
+
+template <class FieldType>
+void DecodeGame(std::span<const std::uint8_t> data,
+                BasicGame<FieldType>& game) {
+  ByteReader reader(data, errors::kInvalidGameEncoding);
+  auto header = ReadHeader(reader);
+  if (header.game.field.player_count != game.field_.GetPlayerCount() ||
+      header.game.rules != game.GetRuleOptions()) {
+    throw errors::kCheckpointMismatch;
+  }
+  CheckTopology(reader, header.game, *game.field_.GetTopology());
+
+  auto player_count = game.field_.GetPlayerCount();
+  auto cell_count = game.field_.GetCellCount();
+  PlayerSet players = PlayerSet::FirstN(player_count);
+  PlayerSet alive(reader.Varint());
+  std::size_t current_player = reader.Byte();
+  auto turn_count = reader.Varint();
+  auto cascade_waves = reader.Varint();
+  auto eliminated = reader.Varint();
+  if ((alive.GetMask() & ~players.GetMask()) != 0 ||
+      (eliminated & ~players.GetMask()) != 0 ||
+      (alive.empty() ? current_player != 0
+                     : !alive.Contains(current_player))) {
+    throw errors::kInvalidGameEncoding;
+  }
+
+  auto move_count = reader.Varint();
+  // Every move takes at least two bytes, so a bogus count cannot allocate
+  if (move_count > data.size() / 2) {
+    throw errors::kInvalidGameEncoding;
+  }
+  std::vector<Move> moves;
+  moves.reserve(move_count);
+  for (std::uint64_t i = 0; i < move_count; ++i) {
+    std::size_t player_index = reader.Byte();
+    auto cell_idx = reader.Varint();
+    if (!players.Contains(player_index) || cell_idx >= cell_count) {
+      throw errors::kInvalidGameEncoding;
+    }
+    moves.push_back(Move{player_index, cell_idx});
+  }
+  if (!reader.AtEnd()) {
+    throw errors::kInvalidGameEncoding;
+  }
+  // Only a game that is over may hold the cells of a cascade cut short
+  DecodeField(header.field_data, game.field_, alive.size() <= 1);
+
+  game.field_.SetPendingEliminated(eliminated);
+  game.move_history_ = std::move(moves);
+  game.alive_players_ = alive;
+  game.current_player_ = current_player;
+  game.turn_count_ = turn_count;
+  game.last_cascade_waves_ = cascade_waves;
+  game.undo_frames_.clear();
+  game.undo_changes_.clear();
+  if (game.reference_) {
+    game.SyncReference();
+  }
+}
+
+AnyGame DecodeGame(std::span<const std::uint8_t> data,
+                   EngineOptions options) {
+  ByteReader reader(data, errors::kInvalidGameEncoding);
+  auto header = ReadHeader(reader).game;
+  auto game = MakeGame(header.field.player_count, ReadTopology(reader, header),
+                       header.rules, options);
+  std::visit([data](auto& restored) { DecodeGame(data, restored); }, game);
+  return game;
+}
+
+template std::vector<std::uint8_t> EncodeGame(const Game& game);
+template void DecodeGame(std::span<const std::uint8_t> data, Game& game);
+#define SPREAD_LOGIC_INSTANTIATE_CODEC(width, height)          \
+  template std::vector<std::uint8_t> EncodeGame(               \
+      const FixedGame<width, height>& game);                   \
+  template void DecodeGame(std::span<const std::uint8_t> data, \
+                           FixedGame<width, height>& game);
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_INSTANTIATE_CODEC)
+#undef SPREAD_LOGIC_INSTANTIATE_CODEC
+#define SPREAD_LOGIC_INSTANTIATE_VARIANT_CODEC(capture, dots)  \
+  template std::vector<std::uint8_t> EncodeGame(               \
+      const VariantGame<capture, dots>& game);                 \
+  template void DecodeGame(std::span<const std::uint8_t> data, \
+                           VariantGame<capture, dots>& game);
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_INSTANTIATE_VARIANT_CODEC)
+#undef SPREAD_LOGIC_INSTANTIATE_VARIANT_CODEC
+
+}  // namespace spread_logic
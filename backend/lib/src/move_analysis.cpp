@@ -0,0 +1,83 @@
+#include "move_analysis.hpp"
+
+#include <algorithm>
+#include <exception>
+
+#include "tile_pool.hpp"
+
+namespace spread_logic {
+
+namespace {
+
+// A task copies the game once and runs its moves through Apply and Undo, so
+// a task should cover enough moves to outweigh the copy
+constexpr std::size_t kMinMovesPerTask = 8;
+constexpr std::size_t kMaxTasks = 64;
+
+}  // namespace
+
+template <class FieldType>
+std::vector<MoveOutcome> EvaluateMoves(const BasicGame<FieldType>& game) {
+  auto alive = game.GetAlivePlayers();
+  if (alive.size() < 2) {
+    return {};
+  }
+
+  std::vector<MoveOutcome> outcomes;
+  for (auto cell_idx : game.GetLegalMoves()) {
+    outcomes.push_back(MoveOutcome{.cell_idx =
+                                       static_cast<std::uint32_t>(cell_idx),
+                                   .scores = {},
+                                   .cascade_waves = 0,
+                                   .eliminated = 0,
+                                   .ends_game = false});
+  }
+  auto task_count = std::clamp<std::size_t>(
+      outcomes.size() / kMinMovesPerTask, 1, kMaxTasks);
+  auto per_task = (outcomes.size() + task_count - 1) / task_count;
+
+  std::vector<std::exception_ptr> errors(task_count);
+  detail::TilePool::Get().Run(task_count, [&](std::size_t t) {
+    try {
+      auto copy = game;
+      auto end = std::min(outcomes.size(), (t + 1) * per_task);
+      for (auto i = t * per_task; i < end; ++i) {
+        auto& outcome = outcomes[i];
+        copy.Apply(outcome.cell_idx);
+        auto scores = copy.GetField().GetPlayerScores();
+        outcome.scores.assign(scores.begin(), scores.end());
+        outcome.cascade_waves = copy.GetLastCascadeWaves();
+        auto left = copy.GetAlivePlayers();
+        outcome.eliminated = alive.GetMask() & ~left.GetMask();
+        outcome.ends_game = left.size() < 2;
+        copy.Undo();
+      }
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  });
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return outcomes;
+}
+
+std::vector<MoveOutcome> EvaluateMoves(const AnyGame& game) {
+  return std::visit([](const auto& g) { return EvaluateMoves(g); }, game);
+}
+
+template std::vector<MoveOutcome> EvaluateMoves(const Game& game);
+#define SPREAD_LOGIC_INSTANTIATE_EVALUATE(width, height) \
+  template std::vector<MoveOutcome> EvaluateMoves(       \
+      const FixedGame<width, height>& game);
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SPREAD_LOGIC_INSTANTIATE_EVALUATE)
+#undef SPREAD_LOGIC_INSTANTIATE_EVALUATE
+#define SPREAD_LOGIC_INSTANTIATE_VARIANT_EVALUATE(capture, dots) \
+  template std::vector<MoveOutcome> EvaluateMoves(                \
+      const VariantGame<capture, dots>& game);
+SPREAD_LOGIC_RULE_VARIANTS(SPREAD_LOGIC_INSTANTIATE_VARIANT_EVALUATE)
+#undef SPREAD_LOGIC_INSTANTIATE_VARIANT_EVALUATE
+
+}  // namespace spread_logic
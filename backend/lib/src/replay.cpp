@@ -0,0 +1,97 @@
+#include "replay.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+#include "game_codec.hpp"
+
+namespace spread_logic {
+
+namespace {
+
+template <class GameType>
+void Verify(const GameType& replayed, const GameType& recorded,
+            ReplayResult& result) {
+  if (replayed.GetAlivePlayers() != recorded.GetAlivePlayers()) {
+    result.error = "alive players differ";
+  } else if (replayed.GetCurrentPlayer() != recorded.GetCurrentPlayer()) {
+    result.error = "current player differs";
+  } else if (replayed.GetCurrentTurn() != recorded.GetCurrentTurn()) {
+    result.error = "turn count differs";
+  } else if (result.hash != recorded.GetHash()) {
+    result.error = "position hash differs";
+  } else if (result.inferred_eliminations == 0 &&
+             !std::ranges::equal(replayed.GetField().GetPlayerScores(),
+                                 recorded.GetField().GetPlayerScores())) {
+    result.error = "scores differ";
+  } else {
+    result.verified = true;
+  }
+}
+
+// Empty board of the same shape, a fixed size is always a rectangle
+template <class GameType>
+GameType MakeEmptyGame(const GameType& recorded) {
+  const auto& field = recorded.GetField();
+  if constexpr (std::is_constructible_v<GameType, std::size_t,
+                                        std::shared_ptr<const Topology>>) {
+    return GameType(field.GetPlayerCount(), field.GetTopology());
+  } else {
+    return GameType(field.GetPlayerCount(), field.GetWidth(),
+                    field.GetHeight());
+  }
+}
+
+template <class GameType>
+void Replay(const GameType& recorded, ReplayResult& result) {
+  auto game = MakeEmptyGame(recorded);
+  const auto& moves = recorded.GetMoveHistory();
+
+  auto start = std::chrono::steady_clock::now();
+  try {
+    for (const auto& move : moves) {
+      if (!game.GetAlivePlayers().Contains(move.player_index)) {
+        throw errors::kPlayerNotAlive;
+      }
+      while (game.GetCurrentPlayer() != move.player_index) {
+        game.EliminatePlayer(game.GetCurrentPlayer());
+        ++result.inferred_eliminations;
+      }
+      game.MakeMove(move.cell_idx);
+      ++result.moves;
+    }
+  } catch (const std::logic_error& e) {
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    result.hash = game.GetHash();
+    result.error = "move " + std::to_string(result.moves) + ": " + e.what();
+    return;
+  }
+  auto missing = game.GetAlivePlayers().GetMask() &
+                 ~recorded.GetAlivePlayers().GetMask();
+  for (auto player_index : PlayerSet(missing)) {
+    game.EliminatePlayer(player_index);
+    ++result.inferred_eliminations;
+  }
+  result.elapsed = std::chrono::steady_clock::now() - start;
+  result.hash = game.GetHash();
+  Verify(game, recorded, result);
+}
+
+}  // namespace
+
+ReplayResult ReplayCheckpoint(std::span<const std::uint8_t> checkpoint) {
+  ReplayResult result;
+  try {
+    auto recorded = DecodeGame(checkpoint);
+    std::visit([&result](const auto& game) { Replay(game, result); },
+               recorded);
+  } catch (const std::logic_error& e) {
+    result.error = e.what();
+  }
+  return result;
+}
+
+}  // namespace spread_logic
@@ -0,0 +1,104 @@
+#include "tile_pool.hpp"
+
+#include <algorithm>
+
+namespace spread_logic::detail {
+
+TilePool& TilePool::Get() {
+  static TilePool pool(
+      std::max<std::size_t>(std::thread::hardware_concurrency(), 1) - 1);
+  return pool;
+}
+
+TilePool::TilePool(std::size_t worker_count) {
+  workers_.reserve(worker_count);
+  for (std::size_t i = 0; i < worker_count; ++i) {
+    workers_.emplace_back([this] { Work(); });
+  }
+}
+
+TilePool::~TilePool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void TilePool::Run(std::size_t task_count,
+                   const std::function<void(std::size_t)>& task) {
+  if (workers_.empty() || task_count < 2 ||
+      busy_.exchange(true, std::memory_order_acquire)) {
+    for (std::size_t i = 0; i < task_count; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard lock(mutex_);
+    task_ = &task;
+    task_count_ = task_count;
+    next_task_.store(0, std::memory_order_relaxed);
+    pending_ = task_count;
+    ++generation_;
+  }
+  wake_.notify_all();
+  Drain(task, task_count);
+
+  // Workers that joined late must leave before task goes out of scope
+  {
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0 && active_ == 0; });
+    task_ = nullptr;
+  }
+  busy_.store(false, std::memory_order_release);
+}
+
+void TilePool::Work() {
+  std::uint64_t seen = 0;
+  std::unique_lock lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+    if (stop_) {
+      return;
+    }
+    seen = generation_;
+    if (task_ == nullptr) {
+      continue;
+    }
+    const auto* task = task_;
+    auto task_count = task_count_;
+    ++active_;
+    lock.unlock();
+    Drain(*task, task_count);
+    lock.lock();
+    if (--active_ == 0 && pending_ == 0) {
+      done_.notify_all();
+    }
+  }
+}
+
+void TilePool::Drain(const std::function<void(std::size_t)>& task,
+                     std::size_t task_count) {
+  std::size_t finished = 0;
+  for (auto i = next_task_.fetch_add(1, std::memory_order_relaxed);
+       i < task_count;
+       i = next_task_.fetch_add(1, std::memory_order_relaxed)) {
+    task(i);
+    ++finished;
+  }
+  if (finished == 0) {
+    return;
+  }
+  std::lock_guard lock(mutex_);
+  pending_ -= finished;
+  if (pending_ == 0 && active_ == 0) {
+    done_.notify_all();
+  }
+}
+
+}  // namespace spread_logic::detail
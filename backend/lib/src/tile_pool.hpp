@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spread_logic::detail {
+
+// Process-wide fork-join pool of the engine: the tiles of one stencil wave,
+// the candidate moves of EvaluateMoves. Runs one job at a time; a caller that
+// finds it busy, also from inside a task, runs its tasks itself, so fields
+// stepped on different threads never wait on each other.
+class TilePool {
+ public:
+  // Created with one worker per hardware thread but the caller's on first use
+  static TilePool& Get();
+
+  TilePool(const TilePool&) = delete;
+  TilePool& operator=(const TilePool&) = delete;
+
+  // Call task(i) for every i in [0, task_count) on the workers and the
+  // calling thread, returns once all calls are done. Tasks must not throw.
+  void Run(std::size_t task_count,
+           const std::function<void(std::size_t)>& task);
+
+ private:
+  explicit TilePool(std::size_t worker_count);
+  ~TilePool();
+
+  void Work();
+  // Take task indices of the current job until none are left
+  void Drain(const std::function<void(std::size_t)>& task,
+             std::size_t task_count);
+
+  std::atomic<bool> busy_{false};  // set by the caller for a whole job
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(std::size_t)>* task_{nullptr};
+  std::size_t task_count_{0};
+  std::atomic<std::size_t> next_task_{0};
+  // Tasks not finished and workers still inside the current job
+  std::size_t pending_{0};
+  std::size_t active_{0};
+  std::uint64_t generation_{0};
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace spread_logic::detail
@@ -0,0 +1,359 @@
+#include "topology.hpp"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+#include "board.hpp"
+
+namespace spread_logic {
+
+namespace {
+
+bool IsValidCellCount(std::uint32_t width, std::uint32_t height) {
+  auto cell_count = static_cast<std::uint64_t>(width) * height;
+  return cell_count >= 2 && cell_count <= UINT32_MAX;
+}
+
+// Topology of a generated kind and size, shared with every live board using
+// it. Unused entries expire with their last board.
+std::shared_ptr<const Topology> GetCached(
+    TopologyKind kind, std::uint32_t width, std::uint32_t height,
+    std::shared_ptr<const Topology> (*build)(std::uint32_t, std::uint32_t)) {
+  static std::mutex mutex;
+  static std::map<std::tuple<TopologyKind, std::uint32_t, std::uint32_t>,
+                  std::weak_ptr<const Topology>>
+      cache;
+
+  std::lock_guard lock(mutex);
+  auto& entry = cache[{kind, width, height}];
+  if (auto topology = entry.lock()) {
+    return topology;
+  }
+  // Building under the lock keeps one copy per size even when many games of
+  // a new size start at once
+  auto topology = build(width, height);
+  entry = topology;
+  std::erase_if(cache, [](const auto& item) { return item.second.expired(); });
+  return topology;
+}
+
+}  // namespace
+
+std::shared_ptr<const Topology> Topology::Rectangle(
+    std::uint32_t width, std::uint32_t height, const std::logic_error& error) {
+  if (!IsValidCellCount(width, height)) {
+    throw error;
+  }
+  return GetCached(
+      TopologyKind::kRectangle, width, height,
+      [](std::uint32_t w, std::uint32_t h) {
+        std::shared_ptr<Topology> topology(new Topology());
+        auto cell_count = std::size_t{w} * h;
+        topology->width_ = w;
+        topology->height_ = h;
+        topology->configuration_.assign(cell_count, 0);
+        topology->capacity_.assign(cell_count, 0);
+        if (cell_count <= kNeighborListMaxCells) {
+          topology->offsets_.assign(cell_count + 1, 0);
+          topology->neighbors_.assign(cell_count * kMaxNeighbors, 0);
+        }
+        BuildBoardTables(
+            w, h, topology->configuration_.data(), topology->capacity_.data(),
+            topology->offsets_.empty() ? nullptr : topology->offsets_.data(),
+            topology->neighbors_.data());
+        topology->neighbors_.resize(topology->offsets_.empty()
+                                        ? 0
+                                        : topology->offsets_.back());
+        return std::shared_ptr<const Topology>(std::move(topology));
+      });
+}
+
+std::shared_ptr<const Topology> Topology::Torus(
+    std::uint32_t width, std::uint32_t height, const std::logic_error& error) {
+  if (!IsValidCellCount(width, height) || width < 3 || height < 3) {
+    throw error;
+  }
+  return GetCached(
+      TopologyKind::kTorus, width, height,
+      [](std::uint32_t w, std::uint32_t h) {
+        std::shared_ptr<Topology> topology(new Topology());
+        topology->kind_ = TopologyKind::kTorus;
+        topology->width_ = w;
+        topology->height_ = h;
+        auto cell_count = std::size_t{w} * h;
+        topology->configuration_.assign(
+            cell_count, static_cast<std::uint8_t>(Sides::TOP | Sides::RIGHT |
+                                                  Sides::BOTTOM | Sides::LEFT));
+        topology->offsets_.reserve(cell_count + 1);
+        topology->neighbors_.reserve(cell_count * 4);
+        topology->offsets_.push_back(0);
+        for (std::uint32_t y = 0; y < h; ++y) {
+          for (std::uint32_t x = 0; x < w; ++x) {
+            auto& list = topology->neighbors_;
+            list.push_back(((y + h - 1) % h) * w + x);
+            list.push_back(y * w + (x + 1) % w);
+            list.push_back(((y + 1) % h) * w + x);
+            list.push_back(y * w + (x + w - 1) % w);
+            topology->offsets_.push_back(
+                static_cast<std::uint32_t>(list.size()));
+          }
+        }
+        topology->Finish(errors::kInvalidTopology);
+        return std::shared_ptr<const Topology>(std::move(topology));
+      });
+}
+
+std::shared_ptr<const Topology> Topology::Hex(
+    std::uint32_t width, std::uint32_t height, const std::logic_error& error) {
+  if (!IsValidCellCount(width, height)) {
+    throw error;
+  }
+  return GetCached(
+      TopologyKind::kHex, width, height, [](std::uint32_t w, std::uint32_t h) {
+        std::shared_ptr<Topology> topology(new Topology());
+        topology->kind_ = TopologyKind::kHex;
+        topology->width_ = w;
+        topology->height_ = h;
+        auto cell_count = std::size_t{w} * h;
+        topology->configuration_.assign(cell_count, 0);
+        topology->offsets_.reserve(cell_count + 1);
+        topology->neighbors_.reserve(cell_count * 6);
+        topology->offsets_.push_back(0);
+        for (std::uint32_t y = 0; y < h; ++y) {
+          // Odd rows sit half a cell to the right, so the diagonal neighbors
+          // of a row are at x - 1 and x on even rows, x and x + 1 on odd ones
+          std::int64_t shift = y % 2;
+          for (std::int64_t x = 0; x < w; ++x) {
+            auto add = [&](std::int64_t nx, std::int64_t ny) {
+              if (nx >= 0 && nx < w && ny >= 0 && ny < h) {
+                topology->neighbors_.push_back(
+                    static_cast<std::uint32_t>(ny * w + nx));
+              }
+            };
+            std::int64_t row = y;
+            add(x - 1 + shift, row - 1);
+            add(x + shift, row - 1);
+            add(x + 1, row);
+            add(x + shift, row + 1);
+            add(x - 1 + shift, row + 1);
+            add(x - 1, row);
+            topology->offsets_.push_back(
+                static_cast<std::uint32_t>(topology->neighbors_.size()));
+          }
+        }
+        topology->Finish(errors::kInvalidTopology);
+        return std::shared_ptr<const Topology>(std::move(topology));
+      });
+}
+
+std::shared_ptr<const Topology> Topology::Moore(
+    std::uint32_t width, std::uint32_t height, const std::logic_error& error) {
+  if (!IsValidCellCount(width, height)) {
+    throw error;
+  }
+  return GetCached(
+      TopologyKind::kMoore, width, height,
+      [](std::uint32_t w, std::uint32_t h) {
+        std::shared_ptr<Topology> topology(new Topology());
+        topology->kind_ = TopologyKind::kMoore;
+        topology->width_ = w;
+        topology->height_ = h;
+        auto cell_count = std::size_t{w} * h;
+        topology->configuration_.assign(cell_count, 0);
+        topology->offsets_.reserve(cell_count + 1);
+        topology->neighbors_.reserve(cell_count * 8);
+        topology->offsets_.push_back(0);
+        for (std::int64_t y = 0; y < h; ++y) {
+          for (std::int64_t x = 0; x < w; ++x) {
+            // Clockwise from the top, like Sides::kTraverse
+            constexpr std::int64_t kSteps[8][2] = {
+                {0, -1}, {1, -1}, {1, 0},  {1, 1},
+                {0, 1},  {-1, 1}, {-1, 0}, {-1, -1}};
+            for (const auto& step : kSteps) {
+              auto nx = x + step[0];
+              auto ny = y + step[1];
+              if (nx >= 0 && nx < w && ny >= 0 && ny < h) {
+                topology->neighbors_.push_back(
+                    static_cast<std::uint32_t>(ny * w + nx));
+              }
+            }
+            topology->offsets_.push_back(
+                static_cast<std::uint32_t>(topology->neighbors_.size()));
+          }
+        }
+        topology->Finish(errors::kInvalidTopology);
+        return std::shared_ptr<const Topology>(std::move(topology));
+      });
+}
+
+std::shared_ptr<const Topology> Topology::FromMap(
+    std::string_view map, const std::logic_error& error) {
+  std::vector<std::string_view> rows;
+  while (!map.empty()) {
+    auto end = map.find('\n');
+    auto row = map.substr(0, end);
+    if (!row.empty() && row.back() == '\r') {
+      row.remove_suffix(1);
+    }
+    if (!row.empty()) {
+      rows.push_back(row);
+    }
+    map.remove_prefix(end == std::string_view::npos ? map.size() : end + 1);
+  }
+  if (rows.empty()) {
+    throw error;
+  }
+  auto width = rows.front().size();
+  if (width > UINT32_MAX || rows.size() > UINT32_MAX ||
+      !IsValidCellCount(static_cast<std::uint32_t>(width),
+                        static_cast<std::uint32_t>(rows.size()))) {
+    throw error;
+  }
+  for (auto row : rows) {
+    if (row.size() != width ||
+        row.find_first_not_of(".#") != std::string_view::npos) {
+      throw error;
+    }
+  }
+
+  std::shared_ptr<Topology> topology(new Topology());
+  topology->kind_ = TopologyKind::kMap;
+  topology->width_ = static_cast<std::uint32_t>(width);
+  topology->height_ = static_cast<std::uint32_t>(rows.size());
+  auto cell_count = width * rows.size();
+  auto is_cell = [&](std::size_t x, std::size_t y) {
+    return rows[y][x] == '.';
+  };
+  topology->configuration_.assign(cell_count, 0);
+  topology->offsets_.reserve(cell_count + 1);
+  topology->offsets_.push_back(0);
+  for (std::size_t y = 0; y < rows.size(); ++y) {
+    for (std::size_t x = 0; x < width; ++x) {
+      auto index = y * width + x;
+      auto& config = topology->configuration_[index];
+      auto& list = topology->neighbors_;
+      if (is_cell(x, y)) {
+        if (y > 0 && is_cell(x, y - 1)) {
+          config |= Sides::TOP;
+          list.push_back(static_cast<std::uint32_t>(index - width));
+        }
+        if (x + 1 < width && is_cell(x + 1, y)) {
+          config |= Sides::RIGHT;
+          list.push_back(static_cast<std::uint32_t>(index + 1));
+        }
+        if (y + 1 < rows.size() && is_cell(x, y + 1)) {
+          config |= Sides::BOTTOM;
+          list.push_back(static_cast<std::uint32_t>(index + width));
+        }
+        if (x > 0 && is_cell(x - 1, y)) {
+          config |= Sides::LEFT;
+          list.push_back(static_cast<std::uint32_t>(index - 1));
+        }
+        // An isolated cell could never fire its dots anywhere
+        if (config == 0) {
+          throw error;
+        }
+      }
+      topology->offsets_.push_back(static_cast<std::uint32_t>(list.size()));
+    }
+  }
+  topology->Finish(error);
+  return topology;
+}
+
+std::shared_ptr<const Topology> Topology::FromNeighbors(
+    std::uint32_t width, std::uint32_t height,
+    std::vector<std::uint32_t> offsets, std::vector<std::uint32_t> neighbors,
+    const std::logic_error& error) {
+  if (!IsValidCellCount(width, height)) {
+    throw error;
+  }
+  auto cell_count = std::size_t{width} * height;
+  if (offsets.size() != cell_count + 1 || offsets.front() != 0 ||
+      offsets.back() != neighbors.size()) {
+    throw error;
+  }
+  // Edges both ways round, equal once sorted when every edge is listed from
+  // both ends as often. A one-way edge would feed a cell that never fires
+  // back, until its fullness wraps.
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> reversed;
+  edges.reserve(neighbors.size());
+  reversed.reserve(neighbors.size());
+  for (std::size_t index = 0; index < cell_count; ++index) {
+    if (offsets[index] > offsets[index + 1]) {
+      throw error;
+    }
+    auto cell = static_cast<std::uint32_t>(index);
+    for (auto k = offsets[index]; k < offsets[index + 1]; ++k) {
+      if (neighbors[k] >= cell_count || neighbors[k] == index) {
+        throw error;
+      }
+      edges.emplace_back(cell, neighbors[k]);
+      reversed.emplace_back(neighbors[k], cell);
+    }
+  }
+  std::ranges::sort(edges);
+  std::ranges::sort(reversed);
+  if (edges != reversed) {
+    throw error;
+  }
+
+  std::shared_ptr<Topology> topology(new Topology());
+  topology->kind_ = TopologyKind::kCustom;
+  topology->width_ = width;
+  topology->height_ = height;
+  topology->configuration_.assign(cell_count, 0);
+  topology->offsets_ = std::move(offsets);
+  topology->neighbors_ = std::move(neighbors);
+  topology->Finish(error);
+  return topology;
+}
+
+void Topology::Finish(const std::logic_error& error) {
+  auto cell_count = offsets_.size() - 1;
+  capacity_.assign(cell_count, 0);
+  std::size_t playable = 0;
+  bool any_blocked = false;
+  for (std::size_t index = 0; index < cell_count; ++index) {
+    auto degree = offsets_[index + 1] - offsets_[index];
+    if (degree > kMaxDegree) {
+      throw error;
+    }
+    capacity_[index] = static_cast<std::uint8_t>(degree);
+    if (degree == 0) {
+      any_blocked = true;
+      continue;
+    }
+    ++playable;
+  }
+  if (playable < 2) {
+    throw error;
+  }
+  // A blocked cell taking dots could never fire them again
+  for (auto neighbor : neighbors_) {
+    if (capacity_[neighbor] == 0) {
+      throw error;
+    }
+  }
+  if (any_blocked) {
+    blocked_.assign((cell_count + 63) / 64, 0);
+    for (std::size_t index = 0; index < cell_count; ++index) {
+      if (capacity_[index] == 0) {
+        blocked_[index / 64] |= std::uint64_t{1} << (index % 64);
+      }
+    }
+  }
+}
+
+bool Topology::operator==(const Topology& other) const {
+  // Capacities and blocked cells follow from the rest
+  return kind_ == other.kind_ && width_ == other.width_ &&
+         height_ == other.height_ && configuration_ == other.configuration_ &&
+         offsets_ == other.offsets_ && neighbors_ == other.neighbors_;
+}
+
+}  // namespace spread_logic
@@ -0,0 +1,89 @@
+#include "wave_kernel.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace spread_logic::detail {
+
+namespace {
+
+#if defined(__SSE2__)
+struct Sse2Ops {
+  using Vec = __m128i;
+  constexpr static std::size_t kLanes = 16;
+  constexpr static unsigned kFullMask = 0xFFFF;
+
+  static Vec Load(const std::uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+  static void Store(std::uint8_t* p, Vec v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+  }
+  static Vec Zero() {
+    return _mm_setzero_si128();
+  }
+  static Vec Set1(std::uint8_t v) {
+    return _mm_set1_epi8(static_cast<char>(v));
+  }
+  static Vec Sub(Vec a, Vec b) {
+    return _mm_sub_epi8(a, b);
+  }
+  static Vec And(Vec a, Vec b) {
+    return _mm_and_si128(a, b);
+  }
+  static Vec AndNot(Vec a, Vec b) {
+    return _mm_andnot_si128(a, b);
+  }
+  static Vec Or(Vec a, Vec b) {
+    return _mm_or_si128(a, b);
+  }
+  static Vec CmpEq(Vec a, Vec b) {
+    return _mm_cmpeq_epi8(a, b);
+  }
+  static Vec Max(Vec a, Vec b) {
+    return _mm_max_epu8(a, b);
+  }
+  static unsigned MoveMask(Vec v) {
+    return static_cast<unsigned>(_mm_movemask_epi8(v));
+  }
+};
+#else
+// No vector unit available, only the scalar tail of the kernels runs
+struct Sse2Ops {
+  constexpr static std::size_t kLanes = 0;
+};
+#endif
+
+#if defined(SPREAD_LOGIC_HAS_AVX2) && defined(__GNUC__)
+bool HasAvx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+}
+#else
+bool HasAvx2() {
+  return false;
+}
+#endif
+
+}  // namespace
+
+const WaveKernel& GetSse2WaveKernel() {
+  static const WaveKernel kKernel{&MarkReady<Sse2Ops>, &ApplyWave<Sse2Ops>,
+                                  &LegalMoves<Sse2Ops>};
+  return kKernel;
+}
+
+const WaveKernel& GetWaveKernel() {
+  static const WaveKernel& kKernel =
+      HasAvx2() ? GetAvx2WaveKernel() : GetSse2WaveKernel();
+  return kKernel;
+}
+
+#if !defined(SPREAD_LOGIC_HAS_AVX2)
+const WaveKernel& GetAvx2WaveKernel() {
+  return GetSse2WaveKernel();
+}
+#endif
+
+}  // namespace spread_logic::detail
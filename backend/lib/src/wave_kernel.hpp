@@ -0,0 +1,262 @@
+#pragma once
+
+// Wave-synchronous spreading kernel shared by the per-ISA translation units.
+// Every template here is instantiated with an Ops type from an anonymous
+// namespace, so each translation unit gets its own copy compiled for its own
+// instruction set. Keep them free of calls to inline functions of other
+// headers (std::min and the like): wave_kernel_avx2.cpp is built with AVX2,
+// and the linker may pick its copy of such a function for the whole program.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "change_set.hpp"
+
+namespace spread_logic::detail {
+
+// Raw view of the field arrays for one wave. `ready` and `fired_owner` are
+// flat per-cell buffers with `width + 1` guard bytes on both sides, so the
+// top and bottom neighbors of border cells read zeros. Left and right
+// neighbors wrap into the adjacent row and are masked with `configuration`.
+struct WaveGrid {
+  std::size_t width;
+  std::size_t cell_count;
+  const std::uint8_t* capacity;
+  const std::uint8_t* configuration;
+  std::uint8_t* fullness;
+  std::uint8_t* owner;
+  std::uint8_t* ready;        // 0xFF for cells firing this wave, guarded
+  std::uint8_t* fired_owner;  // owner of a firing cell when it fires, guarded
+  std::uint64_t* scores;
+  std::uint32_t* owned_cells;
+  std::uint64_t* eliminated;  // bit (owner - 1) set when an owner runs out
+  // Cells changed by the wave in index order, room for one entry per cell
+  CellChange* journal = nullptr;
+  std::size_t* journal_size = nullptr;
+  std::uint32_t journal_wave = 0;
+  // Index of the first cell when the grid is a tile of a larger board: the
+  // per-cell pointers start at that cell, journal entries and the next list
+  // get full-board indices
+  std::size_t first_cell = 0;
+};
+
+struct WaveKernel {
+  // Mark every overfull cell in `ready`, returns the number of marked cells
+  std::size_t (*mark_ready)(const WaveGrid& grid);
+  // Apply one wave of explosions and write the cells that are overfull
+  // afterwards, in ascending order, to `next`. Returns their number.
+  std::size_t (*apply_wave)(const WaveGrid& grid, std::uint32_t* next);
+  // Set bit i % 64 of words[i / 64] for every cell that is unowned or owned
+  // by player and clear all other bits, CellSet layout
+  void (*legal_moves)(const std::uint8_t* owner, std::size_t cell_count,
+                      std::uint8_t player, std::uint64_t* words);
+};
+
+const WaveKernel& GetWaveKernel();
+
+const WaveKernel& GetSse2WaveKernel();
+const WaveKernel& GetAvx2WaveKernel();
+
+// Sides::LEFT and Sides::RIGHT, duplicated to keep this header free of
+// field.hpp
+constexpr std::uint8_t kLeftBit = 8;
+constexpr std::uint8_t kRightBit = 2;
+
+// Ops provides kLanes, kFullMask (MoveMask of an all-ones vector) and unsigned
+// byte-lane operations: Load, Store, Zero, Set1, Sub, And, AndNot (~a & b),
+// Or, CmpEq, Max and MoveMask. kLanes == 0 disables the vector loop and leaves
+// only the scalar tail.
+
+template <class Ops>
+std::size_t MarkReady(const WaveGrid& grid) {
+  std::size_t count = 0;
+  std::size_t i = 0;
+  if constexpr (Ops::kLanes > 0) {
+    for (; i + Ops::kLanes <= grid.cell_count; i += Ops::kLanes) {
+      auto fullness = Ops::Load(grid.fullness + i);
+      auto capacity = Ops::Load(grid.capacity + i);
+      auto ready = Ops::CmpEq(Ops::Max(fullness, capacity), fullness);
+      Ops::Store(grid.ready + i, ready);
+      count +=
+          static_cast<std::size_t>(__builtin_popcount(Ops::MoveMask(ready)));
+    }
+  }
+  for (; i < grid.cell_count; ++i) {
+    bool ready = grid.fullness[i] >= grid.capacity[i];
+    grid.ready[i] = ready ? 0xFF : 0;
+    count += ready ? 1 : 0;
+  }
+  return count;
+}
+
+template <class Ops>
+std::size_t ApplyWave(const WaveGrid& grid, std::uint32_t* next) {
+  const auto width = grid.width;
+  const auto* ready = grid.ready;
+  const auto* fired = grid.fired_owner;
+  std::size_t next_count = 0;
+
+  auto account = [&](std::size_t i, std::uint8_t old_fullness,
+                     std::uint8_t old_owner) {
+    // Dots only move between cells of the firing owner, so the scores follow
+    // the owner and fullness changes of each cell
+    auto new_owner = grid.owner[i];
+    if (grid.journal != nullptr) {
+      grid.journal[(*grid.journal_size)++] =
+          CellChange{static_cast<std::uint32_t>(grid.first_cell + i),
+                     grid.journal_wave,
+                     old_owner, new_owner, old_fullness, grid.fullness[i]};
+    }
+    grid.scores[old_owner] -= old_fullness;
+    grid.scores[new_owner] += grid.fullness[i];
+    if (new_owner != old_owner) {
+      ++grid.owned_cells[new_owner];
+      // May be regained later in the pass, Field::TakeEliminated filters
+      if (--grid.owned_cells[old_owner] == 0 && old_owner != 0) {
+        *grid.eliminated |= std::uint64_t{1} << (old_owner - 1);
+      }
+    }
+  };
+
+  std::size_t i = 0;
+  if constexpr (Ops::kLanes > 0) {
+    const auto zero = Ops::Zero();
+    const auto left_bit = Ops::Set1(kLeftBit);
+    const auto right_bit = Ops::Set1(kRightBit);
+    auto select = [](auto mask, auto value, auto fallback) {
+      return Ops::Or(Ops::And(mask, value), Ops::AndNot(mask, fallback));
+    };
+    for (; i + Ops::kLanes <= grid.cell_count; i += Ops::kLanes) {
+      auto fullness = Ops::Load(grid.fullness + i);
+      auto owner = Ops::Load(grid.owner + i);
+      auto capacity = Ops::Load(grid.capacity + i);
+      auto configuration = Ops::Load(grid.configuration + i);
+
+      auto self = Ops::Load(ready + i);
+      auto top = Ops::Load(ready + i - width);
+      auto bottom = Ops::Load(ready + i + width);
+      auto left = Ops::And(
+          Ops::Load(ready + i - 1),
+          Ops::CmpEq(Ops::And(configuration, left_bit), left_bit));
+      auto right = Ops::And(
+          Ops::Load(ready + i + 1),
+          Ops::CmpEq(Ops::And(configuration, right_bit), right_bit));
+
+      // Masks are 0xFF, so subtracting one adds a dot per firing neighbor
+      auto new_fullness = Ops::Sub(
+          Ops::Sub(Ops::Sub(Ops::Sub(Ops::Sub(fullness, top), bottom), left),
+                   right),
+          Ops::And(self, capacity));
+
+      // The last writer in index order wins: bottom, right, the cell itself,
+      // left, top
+      auto new_owner = select(top, Ops::Load(fired + i - width), owner);
+      new_owner = select(left, Ops::Load(fired + i - 1), new_owner);
+      new_owner = select(self, Ops::Load(fired + i), new_owner);
+      new_owner = select(right, Ops::Load(fired + i + 1), new_owner);
+      new_owner = select(bottom, Ops::Load(fired + i + width), new_owner);
+      new_owner = Ops::AndNot(Ops::CmpEq(new_fullness, zero), new_owner);
+
+      Ops::Store(grid.fullness + i, new_fullness);
+      Ops::Store(grid.owner + i, new_owner);
+
+      auto unchanged = Ops::And(Ops::CmpEq(new_fullness, fullness),
+                                Ops::CmpEq(new_owner, owner));
+      auto changed = ~Ops::MoveMask(unchanged) & Ops::kFullMask;
+      if (changed != 0) {
+        alignas(32) std::uint8_t old_fullness[Ops::kLanes];
+        alignas(32) std::uint8_t old_owner[Ops::kLanes];
+        Ops::Store(old_fullness, fullness);
+        Ops::Store(old_owner, owner);
+        for (; changed != 0; changed &= changed - 1) {
+          auto lane = static_cast<std::size_t>(__builtin_ctz(changed));
+          account(i + lane, old_fullness[lane], old_owner[lane]);
+        }
+      }
+
+      auto overfull = Ops::MoveMask(
+          Ops::CmpEq(Ops::Max(new_fullness, capacity), new_fullness));
+      for (; overfull != 0; overfull &= overfull - 1) {
+        next[next_count++] = static_cast<std::uint32_t>(
+            grid.first_cell + i + __builtin_ctz(overfull));
+      }
+    }
+  }
+
+  for (; i < grid.cell_count; ++i) {
+    auto old_fullness = grid.fullness[i];
+    auto old_owner = grid.owner[i];
+    bool has_left = (grid.configuration[i] & kLeftBit) != 0;
+    bool has_right = (grid.configuration[i] & kRightBit) != 0;
+    bool self = ready[i] != 0;
+    bool top = ready[i - width] != 0;
+    bool bottom = ready[i + width] != 0;
+    bool left = has_left && ready[i - 1] != 0;
+    bool right = has_right && ready[i + 1] != 0;
+
+    std::uint8_t incoming = static_cast<std::uint8_t>(
+        static_cast<int>(top) + static_cast<int>(bottom) +
+        static_cast<int>(left) + static_cast<int>(right));
+    std::uint8_t fullness = old_fullness + incoming;
+    if (self) {
+      fullness -= grid.capacity[i];
+    }
+
+    std::uint8_t owner = old_owner;
+    if (bottom) {
+      owner = fired[i + width];
+    } else if (right) {
+      owner = fired[i + 1];
+    } else if (self) {
+      owner = fired[i];
+    } else if (left) {
+      owner = fired[i - 1];
+    } else if (top) {
+      owner = fired[i - width];
+    }
+    if (fullness == 0) {
+      owner = 0;
+    }
+
+    grid.fullness[i] = fullness;
+    grid.owner[i] = owner;
+    if (fullness != old_fullness || owner != old_owner) {
+      account(i, old_fullness, old_owner);
+    }
+    if (fullness >= grid.capacity[i]) {
+      next[next_count++] = static_cast<std::uint32_t>(grid.first_cell + i);
+    }
+  }
+  return next_count;
+}
+
+template <class Ops>
+void LegalMoves(const std::uint8_t* owner, std::size_t cell_count,
+                std::uint8_t player, std::uint64_t* words) {
+  std::size_t i = 0;
+  if constexpr (Ops::kLanes > 0) {
+    const auto zero = Ops::Zero();
+    const auto self = Ops::Set1(player);
+    for (; i + 64 <= cell_count; i += 64) {
+      std::uint64_t word = 0;
+      for (std::size_t lane = 0; lane < 64; lane += Ops::kLanes) {
+        auto owners = Ops::Load(owner + i + lane);
+        auto legal =
+            Ops::Or(Ops::CmpEq(owners, zero), Ops::CmpEq(owners, self));
+        word |= std::uint64_t{Ops::MoveMask(legal)} << lane;
+      }
+      words[i / 64] = word;
+    }
+  }
+  for (; i < cell_count; i += 64) {
+    std::uint64_t word = 0;
+    auto end = i + 64 < cell_count ? i + 64 : cell_count;
+    for (auto j = i; j < end; ++j) {
+      bool legal = owner[j] == 0 || owner[j] == player;
+      word |= std::uint64_t{legal} << (j - i);
+    }
+    words[i / 64] = word;
+  }
+}
+
+}  // namespace spread_logic::detail
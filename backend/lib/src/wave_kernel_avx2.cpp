@@ -0,0 +1,59 @@
+// Compiled with AVX2 enabled, only called after a runtime CPU check. Include
+// nothing but intrinsics and wave_kernel.hpp, see there.
+#include <immintrin.h>
+
+#include "wave_kernel.hpp"
+
+namespace spread_logic::detail {
+
+namespace {
+
+struct Avx2Ops {
+  using Vec = __m256i;
+  constexpr static std::size_t kLanes = 32;
+  constexpr static unsigned kFullMask = 0xFFFFFFFF;
+
+  static Vec Load(const std::uint8_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  static void Store(std::uint8_t* p, Vec v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+  }
+  static Vec Zero() {
+    return _mm256_setzero_si256();
+  }
+  static Vec Set1(std::uint8_t v) {
+    return _mm256_set1_epi8(static_cast<char>(v));
+  }
+  static Vec Sub(Vec a, Vec b) {
+    return _mm256_sub_epi8(a, b);
+  }
+  static Vec And(Vec a, Vec b) {
+    return _mm256_and_si256(a, b);
+  }
+  static Vec AndNot(Vec a, Vec b) {
+    return _mm256_andnot_si256(a, b);
+  }
+  static Vec Or(Vec a, Vec b) {
+    return _mm256_or_si256(a, b);
+  }
+  static Vec CmpEq(Vec a, Vec b) {
+    return _mm256_cmpeq_epi8(a, b);
+  }
+  static Vec Max(Vec a, Vec b) {
+    return _mm256_max_epu8(a, b);
+  }
+  static unsigned MoveMask(Vec v) {
+    return static_cast<unsigned>(_mm256_movemask_epi8(v));
+  }
+};
+
+}  // namespace
+
+const WaveKernel& GetAvx2WaveKernel() {
+  static const WaveKernel kKernel{&MarkReady<Avx2Ops>, &ApplyWave<Avx2Ops>,
+                                  &LegalMoves<Avx2Ops>};
+  return kKernel;
+}
+
+}  // namespace spread_logic::detail
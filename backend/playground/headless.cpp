@@ -0,0 +1,142 @@
+#include "headless.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "replay.hpp"
+
+namespace {
+
+void PrintReplayUsage() {
+  std::cerr << "Usage: spread_playground --replay [options] PATH...\n"
+               "  PATH                 game checkpoint file, or a directory "
+               "of them\n"
+               "  --threads=N          worker threads, 0 for all cores (0)\n"
+               "  --failures-only      print only replays that do not "
+               "verify\n";
+}
+
+double MovesPerSecond(std::size_t moves, double seconds) {
+  return seconds > 0 ? static_cast<double>(moves) / seconds : 0;
+}
+
+spread_logic::ReplayResult ReplayFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    spread_logic::ReplayResult result;
+    result.error = "cannot read file";
+    return result;
+  }
+  std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+  return spread_logic::ReplayCheckpoint(data);
+}
+
+}  // namespace
+
+int RunReplay(int argc, char** argv) {
+  std::size_t thread_count = 0;
+  bool failures_only = false;
+  std::vector<std::filesystem::path> paths;
+  try {
+    for (int i = 2; i < argc; ++i) {
+      std::string_view arg = argv[i];
+      if (arg.starts_with("--threads=")) {
+        thread_count = std::stoul(std::string(arg.substr(10)));
+      } else if (arg == "--failures-only") {
+        failures_only = true;
+      } else if (arg.starts_with("--")) {
+        PrintReplayUsage();
+        return 1;
+      } else if (std::filesystem::is_directory(arg)) {
+        for (const auto& entry : std::filesystem::directory_iterator(arg)) {
+          if (entry.is_regular_file()) {
+            paths.push_back(entry.path());
+          }
+        }
+      } else {
+        paths.emplace_back(arg);
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    PrintReplayUsage();
+    return 1;
+  }
+  if (paths.empty()) {
+    PrintReplayUsage();
+    return 1;
+  }
+  // Directory order is unspecified, keep the report stable
+  std::sort(paths.begin(), paths.end());
+
+  if (thread_count == 0) {
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min(thread_count, paths.size());
+
+  // Files are handed out one at a time, replays vary a lot in length
+  std::vector<spread_logic::ReplayResult> results(paths.size());
+  std::atomic<std::size_t> next{0};
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(thread_count);
+    for (std::size_t t = 0; t < thread_count; ++t) {
+      workers.emplace_back([&] {
+        for (auto i = next++; i < paths.size(); i = next++) {
+          results[i] = ReplayFile(paths[i]);
+        }
+      });
+    }
+  }
+  auto wall_seconds = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+
+  std::size_t failed = 0;
+  std::size_t total_moves = 0;
+  double replay_seconds = 0;
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    const auto& result = results[i];
+    auto seconds = std::chrono::duration<double>(result.elapsed).count();
+    total_moves += result.moves;
+    replay_seconds += seconds;
+    if (!result.verified) {
+      ++failed;
+    } else if (failures_only) {
+      continue;
+    }
+    std::cout << paths[i].string() << (result.verified ? " ok" : " FAIL")
+              << " moves=" << result.moves << " time_ms=" << seconds * 1e3
+              << " moves_per_s=" << MovesPerSecond(result.moves, seconds)
+              << " hash=" << std::hex << std::setw(16) << std::setfill('0')
+              << result.hash << std::dec << std::setfill(' ');
+    if (result.inferred_eliminations != 0) {
+      std::cout << " inferred_eliminations=" << result.inferred_eliminations;
+    }
+    if (!result.error.empty()) {
+      std::cout << " error=\"" << result.error << "\"";
+    }
+    std::cout << "\n";
+  }
+
+  std::cerr << paths.size() << " replays, " << failed << " failed, "
+            << total_moves << " moves in " << wall_seconds << " s on "
+            << thread_count << " threads: "
+            << MovesPerSecond(total_moves, wall_seconds)
+            << " moves/s overall, "
+            << MovesPerSecond(total_moves, replay_seconds)
+            << " moves/s per thread\n";
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Headless mode of the playground, entered with --replay as the first
+// argument: replays game checkpoints in bulk on all cores, verifies them and
+// reports time and throughput per replay. Returns the process exit code.
+int RunReplay(int argc, char** argv);
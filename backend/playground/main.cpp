@@ -2,16 +2,19 @@
 #include <limits>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "game.hpp"
+#include "headless.hpp"
+#include "mcts_bot.hpp"
 
 static void PrintBoard(const spread_logic::Field& field) {
   const auto& cells = field.GetCells();
   auto w = field.GetWidth();
   auto h = field.GetHeight();
-  for (int y = 0; y < h; ++y) {
-    for (int x = 0; x < w; ++x) {
+  for (std::uint32_t y = 0; y < h; ++y) {
+    for (std::uint32_t x = 0; x < w; ++x) {
       const auto& cell = cells[y * w + x];
       char owner = '.';
       if (cell.owner_index != 0) {
@@ -27,7 +30,11 @@ static void PrintBoard(const spread_logic::Field& field) {
   }
 }
 
-int main() {
+int main(int argc, char** argv) {
+  if (argc > 1 && std::string_view(argv[1]) == "--replay") {
+    return RunReplay(argc, argv);
+  }
+
   std::cout << "Spread Playground\n";
 
   int w = 4, h = 4;
@@ -51,8 +58,14 @@ int main() {
     }
   }
 
-  spread_logic::Game game(p, static_cast<std::uint8_t>(w),
-                          static_cast<std::uint8_t>(h));
+  std::string bots;
+  std::cout << "Enter bot players, e.g. B or BC (default none): ";
+  std::getline(std::cin, bots);
+
+  spread_logic::Game game(p, static_cast<std::uint32_t>(w),
+                          static_cast<std::uint32_t>(h));
+  spread_ai::MctsBot bot(
+      spread_ai::MctsOptions{.time_budget = std::chrono::milliseconds(500)});
 
   while (true) {
     std::cout << "\nCurrent board (owner+fullness):\n";
@@ -63,15 +76,23 @@ int main() {
       break;
     }
     auto active = game.GetCurrentPlayer();
-    std::cout << "Player " << static_cast<char>('A' + active - 1)
-              << " move (x y): ";
+    auto active_name = static_cast<char>('A' + active - 1);
+    if (bots.find(active_name) != std::string::npos) {
+      game.MakeMove(bot);
+      auto cell_idx = game.GetMoveHistory().back().cell_idx;
+      std::cout << "Bot " << active_name << " plays "
+                << cell_idx % game.GetField().GetWidth() << " "
+                << cell_idx / game.GetField().GetWidth() << "\n";
+      continue;
+    }
+    std::cout << "Player " << active_name << " move (x y): ";
     int x = -1, y = -1;
     if (!(std::cin >> x >> y)) {
       std::cout << "Input ended.\n";
       break;
     }
-    auto pos = spread_logic::Coordinate{static_cast<int8_t>(x),
-                                        static_cast<int8_t>(y)};
+    auto pos = spread_logic::Coordinate{static_cast<std::int32_t>(x),
+                                        static_cast<std::int32_t>(y)};
     // consume trailing newline
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     try {
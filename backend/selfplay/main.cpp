@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "bot.hpp"
+#include "game.hpp"
+#include "policies.hpp"
+#include "selfplay_stats.hpp"
+#include "work_stealing.hpp"
+
+namespace {
+
+struct Options {
+  std::uint64_t games{100000};
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> sizes{{8, 8}};
+  std::vector<std::size_t> players{2};
+  std::vector<spread_logic::RuleOptions> rules{
+      spread_logic::ClassicRules::kOptions};
+  // Seat i plays policies[i % size]
+  std::vector<std::string> policies{"random"};
+  std::size_t threads{0};
+  std::uint64_t seed{0};
+  // Games still running after this many moves per cell are stalled, 0 for no
+  // limit. Rules without capture rarely end.
+  std::size_t max_moves_per_cell{16};
+  std::string output;
+};
+
+void PrintUsage() {
+  std::cerr
+      << "Usage: spread_selfplay [options]\n"
+         "  --games=N            games in total, spread over all configs "
+         "(100000)\n"
+         "  --sizes=WxH,...      board sizes (8x8)\n"
+         "  --players=N,...      player counts, 2 to 64 (2)\n"
+         "  --rules=R,...        rule sets as capture:N or nocapture:N for N "
+         "dots per move (capture:1)\n"
+         "  --policies=P,...     policy per seat, cycled: random, greedy, "
+         "mcts, alphabeta (random)\n"
+         "  --threads=N          worker threads, 0 for all cores (0)\n"
+         "  --max-moves-per-cell=N\n"
+         "                       stop games after N moves per cell, 0 for "
+         "no limit (16)\n"
+         "  --seed=N             base seed (0)\n"
+         "  --output=PATH        write JSON statistics there instead of "
+         "stdout\n";
+}
+
+std::vector<std::string> Split(std::string_view text) {
+  std::vector<std::string> parts;
+  std::istringstream in{std::string(text)};
+  for (std::string part; std::getline(in, part, ',');) {
+    parts.push_back(part);
+  }
+  return parts;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    auto eq = arg.find('=');
+    if (!arg.starts_with("--") || eq == std::string_view::npos) {
+      return false;
+    }
+    auto key = arg.substr(2, eq - 2);
+    auto value = arg.substr(eq + 1);
+    try {
+      if (key == "games") {
+        options.games = std::stoull(std::string(value));
+      } else if (key == "sizes") {
+        options.sizes.clear();
+        for (const auto& size : Split(value)) {
+          auto x = size.find('x');
+          if (x == std::string::npos) {
+            return false;
+          }
+          options.sizes.emplace_back(std::stoul(size.substr(0, x)),
+                                     std::stoul(size.substr(x + 1)));
+        }
+      } else if (key == "players") {
+        options.players.clear();
+        for (const auto& count : Split(value)) {
+          auto players = std::stoul(count);
+          if (players < 2 || players > spread_logic::kMaxPlayers) {
+            return false;
+          }
+          options.players.push_back(players);
+        }
+      } else if (key == "rules") {
+        options.rules.clear();
+        for (const auto& rules : Split(value)) {
+          auto colon = rules.find(':');
+          auto capture = rules.substr(0, colon);
+          if (colon == std::string::npos ||
+              (capture != "capture" && capture != "nocapture")) {
+            return false;
+          }
+          auto dots = std::stoul(rules.substr(colon + 1));
+          if (dots < 1 || dots > UINT8_MAX) {
+            return false;
+          }
+          options.rules.push_back(spread_logic::RuleOptions{
+              capture == "capture", static_cast<std::uint8_t>(dots)});
+        }
+      } else if (key == "policies") {
+        options.policies = Split(value);
+      } else if (key == "threads") {
+        options.threads = std::stoul(std::string(value));
+      } else if (key == "seed") {
+        options.seed = std::stoull(std::string(value));
+      } else if (key == "max-moves-per-cell") {
+        options.max_moves_per_cell = std::stoul(std::string(value));
+      } else if (key == "output") {
+        options.output = value;
+      } else {
+        return false;
+      }
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+  for (const auto& name : options.policies) {
+    if (std::ranges::find(GetPolicyNames(), name) == GetPolicyNames().end()) {
+      std::cerr << "Unknown policy " << name << "\n";
+      return false;
+    }
+  }
+  return !options.sizes.empty() && !options.players.empty() &&
+         !options.rules.empty() && !options.policies.empty();
+}
+
+std::uint64_t MixSeed(std::uint64_t seed, std::uint64_t index) {
+  std::uint64_t x = seed + 0x9E3779B97F4A7C15ULL * (index + 1);
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// Policies of every seat, one set per game type MakeGame may pick
+template <class AnyGame>
+struct SeatPolicies;
+
+template <class... GameTypes>
+struct SeatPolicies<std::variant<GameTypes...>> {
+  std::tuple<std::vector<std::unique_ptr<BasicPolicy<GameTypes>>>...> seats;
+};
+
+// Per-thread state: policies for every seat and statistics per config
+struct Worker {
+  // Policy name per seat
+  std::vector<std::string> seat_policies;
+  SeatPolicies<spread_logic::AnyGame> policies;
+  std::vector<SelfplayStats> stats;
+
+  // Policies of the seats for GameType, made on first use
+  template <class GameType>
+  std::vector<std::unique_ptr<BasicPolicy<GameType>>>& GetSeats() {
+    auto& seats = std::get<std::vector<std::unique_ptr<BasicPolicy<GameType>>>>(
+        policies.seats);
+    if (seats.empty()) {
+      for (const auto& name : seat_policies) {
+        seats.push_back(MakePolicy<GameType>(name));
+      }
+    }
+    return seats;
+  }
+};
+
+// Game on the engine the server would pick for a lobby of the config
+spread_logic::AnyGame MakeConfigGame(const GameConfig& config) {
+  return spread_logic::MakeGame(
+      config.players,
+      spread_logic::Topology::Rectangle(config.width, config.height),
+      config.rules);
+}
+
+void PlayGame(const GameConfig& config, std::size_t max_moves_per_cell,
+              std::uint64_t seed, Worker& worker, SelfplayStats& stats) {
+  auto any_game = MakeConfigGame(config);
+  std::visit(
+      [&](auto& game) {
+        using GameType = std::remove_cvref_t<decltype(game)>;
+        auto& seats = worker.GetSeats<GameType>();
+        for (std::size_t seat = 0; seat < config.players; ++seat) {
+          seats[seat]->Reset(MixSeed(seed, seat));
+        }
+        auto max_moves = max_moves_per_cell * game.GetField().GetCellCount();
+        std::size_t moves = 0;
+        while (game.GetAlivePlayers().size() > 1) {
+          if (max_moves != 0 && moves == max_moves) {
+            stats.RecordStalledGame(moves);
+            return;
+          }
+          auto& policy = *seats[game.GetCurrentPlayer() - 1];
+          try {
+            game.MakeMove(policy);
+          } catch (const std::logic_error&) {
+            // Tiny boards can leave a player without a cell to play
+            if (!game.GetLegalMoves().empty()) {
+              throw;
+            }
+            stats.RecordStalledGame(moves);
+            return;
+          }
+          ++moves;
+          stats.RecordMove(game.GetLastCascadeWaves());
+        }
+        stats.RecordGame(moves, game.GetAlivePlayers().front());
+      },
+      any_game);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage();
+    return 1;
+  }
+
+  std::vector<GameConfig> configs;
+  std::size_t max_players = 0;
+  for (auto [width, height] : options.sizes) {
+    for (auto players : options.players) {
+      for (auto rules : options.rules) {
+        configs.push_back(GameConfig{width, height, players, rules});
+        max_players = std::max(max_players, players);
+      }
+    }
+  }
+  // Reject sizes and rule sets without an engine before any game starts
+  for (const auto& config : configs) {
+    try {
+      MakeConfigGame(config);
+    } catch (const std::logic_error& e) {
+      std::cerr << "Cannot play " << config.width << "x" << config.height
+                << ": " << e.what() << "\n";
+      return 1;
+    }
+  }
+
+  WorkStealingScheduler scheduler(options.threads);
+  std::vector<Worker> workers(scheduler.GetThreadCount());
+  for (auto& worker : workers) {
+    for (std::size_t seat = 0; seat < max_players; ++seat) {
+      worker.seat_policies.push_back(
+          options.policies[seat % options.policies.size()]);
+    }
+    for (const auto& config : configs) {
+      worker.stats.emplace_back(config.players);
+    }
+  }
+
+  // Game i uses config i % configs.size() and a seed derived from i, so the
+  // results only depend on the options, not on the thread count
+  auto start = std::chrono::steady_clock::now();
+  try {
+    scheduler.Run(options.games, [&](std::size_t worker_index,
+                                     std::uint64_t index) {
+      auto config_index = index % configs.size();
+      auto& worker = workers[worker_index];
+      PlayGame(configs[config_index], options.max_moves_per_cell,
+               MixSeed(options.seed, index), worker,
+               worker.stats[config_index]);
+    });
+  } catch (const std::exception& e) {
+    std::cerr << "Self-play failed: " << e.what() << "\n";
+    return 1;
+  }
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output);
+    if (!file) {
+      std::cerr << "Cannot write " << options.output << "\n";
+      return 1;
+    }
+  }
+  std::ostream& out = options.output.empty() ? std::cout : file;
+  out << "{\"games\":" << options.games
+      << ",\"threads\":" << scheduler.GetThreadCount()
+      << ",\"seed\":" << options.seed << ",\"seconds\":" << seconds
+      << ",\"policies\":[";
+  for (std::size_t i = 0; i < options.policies.size(); ++i) {
+    out << (i > 0 ? "," : "") << "\"" << options.policies[i] << "\"";
+  }
+  out << "],\"configs\":[";
+  for (std::size_t i = 0; i < configs.size(); ++i) {
+    auto stats = workers.front().stats[i];
+    for (std::size_t w = 1; w < workers.size(); ++w) {
+      stats.Merge(workers[w].stats[i]);
+    }
+    out << (i > 0 ? "," : "") << "{\"width\":" << configs[i].width
+        << ",\"height\":" << configs[i].height
+        << ",\"players\":" << configs[i].players
+        << ",\"capture_enemies\":"
+        << (configs[i].rules.capture_enemies ? "true" : "false")
+        << ",\"dots_per_move\":" << int{configs[i].rules.dots_per_move}
+        << ",\"stats\":";
+    stats.WriteJson(out);
+    out << "}";
+  }
+  out << "]}\n";
+
+  std::cerr << options.games << " games in " << seconds << " s\n";
+  return 0;
+}
@@ -0,0 +1,209 @@
+#include "policies.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+#include "alpha_beta_bot.hpp"
+#include "bot.hpp"
+#include "mcts_bot.hpp"
+
+namespace {
+
+// splitmix64
+class Random {
+ public:
+  void Seed(std::uint64_t seed) {
+    state_ = seed;
+  }
+
+  std::uint64_t Next() {
+    std::uint64_t x = (state_ += 0x9E3779B97F4A7C15ULL);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+  }
+
+  // Uniform in [0, bound), bound below 2^32
+  std::size_t Below(std::size_t bound) {
+    return static_cast<std::size_t>(((Next() >> 32) * bound) >> 32);
+  }
+
+ private:
+  std::uint64_t state_{0};
+};
+
+// Uniformly random legal move
+template <class GameType>
+class RandomPolicy : public BasicPolicy<GameType> {
+ public:
+  void Reset(std::uint64_t seed) override {
+    random_.Seed(seed);
+  }
+
+  std::size_t ChooseMove(const GameType& game) override {
+    // Most cells are legal for most of the game, so sampling beats a scan
+    const auto& field = game.GetField();
+    auto player_index = game.GetCurrentPlayer();
+    for (int attempt = 0; attempt < 16; ++attempt) {
+      auto cell = random_.Below(field.GetCellCount());
+      if (field.IsLegalMove(player_index, cell)) {
+        return cell;
+      }
+    }
+    spread_ai::CollectLegalMoves(game, legal_);
+    if (legal_.empty()) {
+      throw spread_ai::errors::kNoLegalMoves;
+    }
+    return legal_[random_.Below(legal_.size())];
+  }
+
+ private:
+  Random random_;
+  std::vector<std::uint32_t> legal_;
+};
+
+// One ply lookahead: the move that leaves the mover furthest ahead of the
+// strongest opponent in dots plus cells, ties broken at random
+template <class GameType>
+class GreedyPolicy : public BasicPolicy<GameType> {
+ public:
+  void Reset(std::uint64_t seed) override {
+    random_.Seed(seed);
+  }
+
+  std::size_t ChooseMove(const GameType& game) override {
+    spread_ai::CollectLegalMoves(game, legal_);
+    if (legal_.empty()) {
+      throw spread_ai::errors::kNoLegalMoves;
+    }
+    if (!scratch_) {
+      scratch_.emplace(game);
+    } else {
+      *scratch_ = game;
+    }
+    auto player_index = game.GetCurrentPlayer();
+    std::optional<std::int64_t> best_score;
+    std::size_t best_move = legal_.front();
+    std::size_t ties = 0;
+    for (auto move : legal_) {
+      scratch_->Apply(move);
+      auto score = Evaluate(*scratch_, player_index);
+      scratch_->Undo();
+      if (!best_score || score > *best_score) {
+        best_score = score;
+        best_move = move;
+        ties = 1;
+      } else if (score == *best_score && random_.Below(++ties) == 0) {
+        best_move = move;
+      }
+    }
+    return best_move;
+  }
+
+ private:
+  static std::int64_t Evaluate(const GameType& game,
+                               std::size_t player_index) {
+    auto alive = game.GetAlivePlayers();
+    if (!alive.Contains(player_index)) {
+      return INT64_MIN;
+    }
+    if (alive.size() == 1) {
+      return INT64_MAX;
+    }
+    const auto& scores = game.GetField().GetPlayerScores();
+    const auto& owned = game.GetField().GetOwnedCells();
+    auto material = [&](std::size_t index) {
+      return static_cast<std::int64_t>(scores[index]) + owned[index];
+    };
+    std::int64_t strongest = 0;
+    for (auto index : alive) {
+      if (index != player_index) {
+        strongest = std::max(strongest, material(index));
+      }
+    }
+    return material(player_index) - strongest;
+  }
+
+  Random random_;
+  std::vector<std::uint32_t> legal_;
+  std::optional<GameType> scratch_;
+};
+
+// Single-threaded bots with small budgets; the games run in parallel instead
+template <class GameType>
+class MctsPolicy : public BasicPolicy<GameType> {
+ public:
+  void Reset(std::uint64_t seed) override {
+    bot_.emplace(spread_ai::MctsOptions{.time_budget = {},
+                                       .playout_budget = 200,
+                                       .thread_count = 1,
+                                       .seed = seed});
+  }
+
+  std::size_t ChooseMove(const GameType& game) override {
+    return bot_->ChooseMove(game);
+  }
+
+ private:
+  std::optional<spread_ai::BasicMctsBot<GameType>> bot_;
+};
+
+template <class GameType>
+class AlphaBetaPolicy : public BasicPolicy<GameType> {
+ public:
+  void Reset(std::uint64_t /*seed*/) override {
+    // A fresh table per game keeps the results independent of game order
+    bot_.emplace(spread_ai::AlphaBetaOptions{.time_budget = {},
+                                             .max_depth = 2,
+                                             .thread_count = 1,
+                                             .table_size_mb = 1});
+  }
+
+  std::size_t ChooseMove(const GameType& game) override {
+    return bot_->ChooseMove(game);
+  }
+
+ private:
+  std::optional<spread_ai::BasicAlphaBetaBot<GameType>> bot_;
+};
+
+}  // namespace
+
+const std::vector<std::string>& GetPolicyNames() {
+  static const std::vector<std::string> kNames = {"random", "greedy", "mcts",
+                                                  "alphabeta"};
+  return kNames;
+}
+
+template <class GameType>
+std::unique_ptr<BasicPolicy<GameType>> MakePolicy(const std::string& name) {
+  if (name == "random") {
+    return std::make_unique<RandomPolicy<GameType>>();
+  }
+  if (name == "greedy") {
+    return std::make_unique<GreedyPolicy<GameType>>();
+  }
+  if (name == "mcts") {
+    return std::make_unique<MctsPolicy<GameType>>();
+  }
+  if (name == "alphabeta") {
+    return std::make_unique<AlphaBetaPolicy<GameType>>();
+  }
+  return nullptr;
+}
+
+template std::unique_ptr<BasicPolicy<spread_logic::Game>> MakePolicy(
+    const std::string& name);
+#define SELFPLAY_INSTANTIATE_FIXED_POLICY(width, height)   \
+  template std::unique_ptr<                                \
+      BasicPolicy<spread_logic::FixedGame<width, height>>> \
+  MakePolicy(const std::string& name);
+SPREAD_LOGIC_FIXED_BOARD_SIZES(SELFPLAY_INSTANTIATE_FIXED_POLICY)
+#undef SELFPLAY_INSTANTIATE_FIXED_POLICY
+#define SELFPLAY_INSTANTIATE_VARIANT_POLICY(capture, dots)   \
+  template std::unique_ptr<                                  \
+      BasicPolicy<spread_logic::VariantGame<capture, dots>>> \
+  MakePolicy(const std::string& name);
+SPREAD_LOGIC_RULE_VARIANTS(SELFPLAY_INSTANTIATE_VARIANT_POLICY)
+#undef SELFPLAY_INSTANTIATE_VARIANT_POLICY
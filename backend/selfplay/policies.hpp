@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "game.hpp"
+
+// Move policy for one seat of a game of GameType. Reset is called before
+// every game with a seed derived from the game index, so results do not
+// depend on which worker plays which game.
+template <class GameType>
+class BasicPolicy : public spread_logic::BasicMoveSource<GameType> {
+ public:
+  virtual void Reset(std::uint64_t seed) = 0;
+};
+
+// Names accepted by MakePolicy
+const std::vector<std::string>& GetPolicyNames();
+
+// Returns nullptr for an unknown name. Defined for every alternative of
+// spread_logic::AnyGame.
+template <class GameType>
+std::unique_ptr<BasicPolicy<GameType>> MakePolicy(const std::string& name);
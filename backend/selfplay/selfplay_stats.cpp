@@ -0,0 +1,112 @@
+#include "selfplay_stats.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Smallest value with at least the given share of the histogram at or below
+std::size_t Percentile(const std::vector<std::uint64_t>& histogram,
+                       std::uint64_t total, double share) {
+  std::uint64_t seen = 0;
+  for (std::size_t value = 0; value < histogram.size(); ++value) {
+    seen += histogram[value];
+    if (seen > 0 && static_cast<double>(seen) >= share * total) {
+      return value;
+    }
+  }
+  return 0;
+}
+
+void WriteHistogram(std::ostream& out,
+                    const std::vector<std::uint64_t>& histogram) {
+  // Sparse [value, count] pairs, long games leave most lengths empty
+  out << "[";
+  bool first = true;
+  for (std::size_t value = 0; value < histogram.size(); ++value) {
+    if (histogram[value] == 0) {
+      continue;
+    }
+    out << (first ? "" : ",") << "[" << value << "," << histogram[value]
+        << "]";
+    first = false;
+  }
+  out << "]";
+}
+
+}  // namespace
+
+SelfplayStats::SelfplayStats(std::size_t players)
+    : wins_(players + 1, 0) {
+}
+
+void SelfplayStats::RecordMove(std::size_t cascade_waves) {
+  ++moves_;
+  Add(cascade_waves_, cascade_waves);
+}
+
+void SelfplayStats::RecordGame(std::size_t moves, std::size_t winner) {
+  ++games_;
+  ++wins_[winner];
+  Add(game_lengths_, moves);
+}
+
+void SelfplayStats::RecordStalledGame(std::size_t moves) {
+  ++games_;
+  ++stalled_games_;
+  Add(game_lengths_, moves);
+}
+
+void SelfplayStats::Merge(const SelfplayStats& other) {
+  games_ += other.games_;
+  stalled_games_ += other.stalled_games_;
+  moves_ += other.moves_;
+  for (std::size_t i = 0; i < wins_.size(); ++i) {
+    wins_[i] += other.wins_[i];
+  }
+  for (std::size_t i = 0; i < other.game_lengths_.size(); ++i) {
+    Add(game_lengths_, i, other.game_lengths_[i]);
+  }
+  for (std::size_t i = 0; i < other.cascade_waves_.size(); ++i) {
+    Add(cascade_waves_, i, other.cascade_waves_[i]);
+  }
+}
+
+void SelfplayStats::WriteJson(std::ostream& out) const {
+  auto rate = [this](std::uint64_t count) {
+    return games_ == 0 ? 0.0 : static_cast<double>(count) / games_;
+  };
+  out << "{\"games\":" << games_ << ",\"stalled_games\":" << stalled_games_
+      << ",\"first_player_win_rate\":" << rate(wins_.size() > 1 ? wins_[1] : 0)
+      << ",\"win_rate_by_player\":[";
+  for (std::size_t i = 1; i < wins_.size(); ++i) {
+    out << (i > 1 ? "," : "") << rate(wins_[i]);
+  }
+  out << "],\"game_length\":{\"mean\":"
+      << (games_ == 0 ? 0.0 : static_cast<double>(moves_) / games_)
+      << ",\"p10\":" << Percentile(game_lengths_, games_, 0.1)
+      << ",\"p50\":" << Percentile(game_lengths_, games_, 0.5)
+      << ",\"p90\":" << Percentile(game_lengths_, games_, 0.9)
+      << ",\"max\":" << (game_lengths_.empty() ? 0 : game_lengths_.size() - 1)
+      << ",\"histogram\":";
+  WriteHistogram(out, game_lengths_);
+  out << "},\"cascade_waves\":{\"mean\":";
+  std::uint64_t total_waves = 0;
+  for (std::size_t i = 0; i < cascade_waves_.size(); ++i) {
+    total_waves += i * cascade_waves_[i];
+  }
+  out << (moves_ == 0 ? 0.0 : static_cast<double>(total_waves) / moves_)
+      << ",\"p99\":" << Percentile(cascade_waves_, moves_, 0.99)
+      << ",\"max\":"
+      << (cascade_waves_.empty() ? 0 : cascade_waves_.size() - 1)
+      << ",\"histogram\":";
+  WriteHistogram(out, cascade_waves_);
+  out << "}}";
+}
+
+void SelfplayStats::Add(std::vector<std::uint64_t>& histogram,
+                        std::size_t value, std::uint64_t count) {
+  if (histogram.size() <= value) {
+    histogram.resize(value + 1, 0);
+  }
+  histogram[value] += count;
+}
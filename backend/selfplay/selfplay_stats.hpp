@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "rules.hpp"
+
+// Board size, player count and rules of one batch of games
+struct GameConfig {
+  std::uint32_t width;
+  std::uint32_t height;
+  std::size_t players;
+  spread_logic::RuleOptions rules;
+};
+
+// Aggregated results of the games of one config. Every worker fills its own
+// copy and the copies are merged at the end, so recording takes no locks.
+class SelfplayStats {
+ public:
+  explicit SelfplayStats(std::size_t players);
+
+  // Cascade length in waves of a single move
+  void RecordMove(std::size_t cascade_waves);
+
+  // A finished game with its number of moves and winning player index
+  // (1-based)
+  void RecordGame(std::size_t moves, std::size_t winner);
+
+  // A game without a winner: the active player was left without a legal
+  // move or the move limit ran out
+  void RecordStalledGame(std::size_t moves);
+
+  void Merge(const SelfplayStats& other);
+
+  // JSON object with win rates, game length and cascade depth histograms
+  void WriteJson(std::ostream& out) const;
+
+ private:
+  static void Add(std::vector<std::uint64_t>& histogram, std::size_t value,
+                  std::uint64_t count = 1);
+
+  std::uint64_t games_{0};
+  std::uint64_t stalled_games_{0};
+  std::uint64_t moves_{0};
+  std::vector<std::uint64_t> wins_;  // by player index, 0 unused
+  // Counts indexed by value
+  std::vector<std::uint64_t> game_lengths_;
+  std::vector<std::uint64_t> cascade_waves_;
+};
@@ -0,0 +1,101 @@
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+WorkStealingScheduler::WorkStealingScheduler(std::size_t thread_count)
+    : thread_count_(thread_count != 0
+                        ? thread_count
+                        : std::max(1U, std::thread::hardware_concurrency())),
+      ranges_(std::make_unique<Range[]>(thread_count_)) {
+}
+
+void WorkStealingScheduler::Run(std::uint64_t job_count, const Job& job) {
+  for (std::size_t i = 0; i < thread_count_; ++i) {
+    ranges_[i].begin = job_count * i / thread_count_;
+    ranges_[i].end = job_count * (i + 1) / thread_count_;
+  }
+
+  std::atomic<bool> failed{false};
+  std::exception_ptr failure;
+  std::mutex failure_mutex;
+  auto work = [&](std::size_t worker) {
+    std::uint64_t index = 0;
+    while (!failed && (Pop(worker, index) || (Steal(worker) &&
+                                              Pop(worker, index)))) {
+      try {
+        job(worker, index);
+      } catch (...) {
+        std::lock_guard lock(failure_mutex);
+        if (!failure) {
+          failure = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count_ - 1);
+  for (std::size_t i = 1; i < thread_count_; ++i) {
+    threads.emplace_back(work, i);
+  }
+  work(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+bool WorkStealingScheduler::Pop(std::size_t worker, std::uint64_t& index) {
+  auto& range = ranges_[worker];
+  std::lock_guard lock(range.mutex);
+  if (range.begin == range.end) {
+    return false;
+  }
+  index = range.begin++;
+  return true;
+}
+
+bool WorkStealingScheduler::Steal(std::size_t worker) {
+  // Retry while some victim still has work, it may be taken by others first
+  while (true) {
+    std::size_t victim = worker;
+    std::uint64_t largest = 0;
+    for (std::size_t i = 0; i < thread_count_; ++i) {
+      if (i == worker) {
+        continue;
+      }
+      std::lock_guard lock(ranges_[i].mutex);
+      if (ranges_[i].end - ranges_[i].begin > largest) {
+        largest = ranges_[i].end - ranges_[i].begin;
+        victim = i;
+      }
+    }
+    if (largest == 0) {
+      return false;
+    }
+
+    std::uint64_t begin = 0;
+    std::uint64_t end = 0;
+    {
+      std::lock_guard lock(ranges_[victim].mutex);
+      auto& range = ranges_[victim];
+      if (range.begin == range.end) {
+        continue;
+      }
+      end = range.end;
+      begin = range.begin + (range.end - range.begin) / 2;
+      range.end = begin;
+    }
+    std::lock_guard lock(ranges_[worker].mutex);
+    ranges_[worker].begin = begin;
+    ranges_[worker].end = end;
+    return true;
+  }
+}
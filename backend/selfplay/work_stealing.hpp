@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// Runs a fixed number of independent jobs on a pool of threads.
+//
+// Every worker starts with an equal slice of the job indices and takes jobs
+// from the front of its own range. A worker that runs dry steals the back
+// half of the largest range left, so uneven jobs (big boards, long games)
+// still keep all threads busy until the end. Jobs never create jobs, so the
+// run is over once every range is empty.
+class WorkStealingScheduler {
+ public:
+  using Job = std::function<void(std::size_t worker, std::uint64_t index)>;
+
+  // 0 threads uses every hardware thread
+  explicit WorkStealingScheduler(std::size_t thread_count);
+
+  std::size_t GetThreadCount() const {
+    return thread_count_;
+  }
+
+  // Call job for every index in [0, job_count), blocks until all are done.
+  // The first exception thrown by a job is rethrown after the workers stop.
+  void Run(std::uint64_t job_count, const Job& job);
+
+ private:
+  struct alignas(64) Range {
+    std::mutex mutex;
+    std::uint64_t begin{0};
+    std::uint64_t end{0};
+  };
+
+  bool Pop(std::size_t worker, std::uint64_t& index);
+  bool Steal(std::size_t worker);
+
+  std::size_t thread_count_;
+  std::unique_ptr<Range[]> ranges_;
+};
@@ -2,29 +2,103 @@
 
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
+#include <spdlog/spdlog.h>
+#include <variant>
 
+#include "errors.hpp"
 #include "game.hpp"
+#include "game_codec.hpp"
 #include "lobby_manager.hpp"
 #include "session.hpp"
 
+namespace {
+
+// Moves firing more cells than this hold the strand long enough to log
+constexpr std::uint64_t kSlowMoveCells = 1 << 20;
+
+// Game on the engine compiled for the lobby board and rules
+spread_logic::AnyGame MakeLobbyGame(const models::Lobby& lobby) {
+  return spread_logic::MakeGame(lobby.players.size(),
+                                GameCoordinator::MakeTopology(lobby.options),
+                                GameCoordinator::MakeRules(lobby.options));
+}
+
+}  // namespace
+
+std::shared_ptr<const spread_logic::Topology> GameCoordinator::MakeTopology(
+    const models::LobbyOptions& options) {
+  using spread_logic::Topology;
+  auto width = static_cast<std::uint32_t>(options.width);
+  auto height = static_cast<std::uint32_t>(options.height);
+  if (options.topology == "rectangle") {
+    return Topology::Rectangle(width, height);
+  }
+  if (options.topology == "torus") {
+    return Topology::Torus(width, height);
+  }
+  if (options.topology == "hex") {
+    return Topology::Hex(width, height);
+  }
+  if (options.topology == "moore") {
+    return Topology::Moore(width, height);
+  }
+  if (options.topology == "map") {
+    return Topology::FromMap(options.map);
+  }
+  throw spread_logic::errors::kInvalidTopology;
+}
+
+spread_logic::RuleOptions GameCoordinator::MakeRules(
+    const models::LobbyOptions& options) {
+  if (options.dots_per_move < 1 || options.dots_per_move > UINT8_MAX) {
+    throw spread_logic::errors::kUnsupportedRules;
+  }
+  spread_logic::RuleOptions rules{
+      options.capture_enemies,
+      static_cast<std::uint8_t>(options.dots_per_move)};
+  if (!spread_logic::HasEngine(rules)) {
+    throw spread_logic::errors::kUnsupportedRules;
+  }
+  return rules;
+}
+
 std::shared_ptr<GameCoordinator> GameCoordinator::Create(
     LobbyManager& lobby_manager, const models::Lobby& lobby, ExecutorType exec,
     std::vector<std::weak_ptr<Session>> sessions) {
   auto game = std::make_shared<GameCoordinator>(
       lobby_manager, lobby, std::move(exec), std::move(sessions));
+  Attach(game);
+  return game;
+}
+
+std::shared_ptr<GameCoordinator> GameCoordinator::Restore(
+    LobbyManager& lobby_manager, const models::Lobby& lobby, ExecutorType exec,
+    std::vector<std::weak_ptr<Session>> sessions,
+    std::span<const std::uint8_t> checkpoint) {
+  auto game = std::make_shared<GameCoordinator>(
+      lobby_manager, lobby, std::move(exec), std::move(sessions));
+  // The checkpoint carries its board and rules, which must match the ones
+  // the lobby options make
+  std::visit(
+      [&](auto& restored) { spread_logic::DecodeGame(checkpoint, restored); },
+      game->game_);
+  Attach(game);
+  return game;
+}
+
+void GameCoordinator::Attach(const std::shared_ptr<GameCoordinator>& game) {
   for (const auto& wptr : game->sessions_) {
     if (auto s = wptr.lock()) {
       s->SetGame(game);
     }
   }
-  return game;
 }
 
 GameCoordinator::GameCoordinator(LobbyManager& lobby_manager,
                                  const models::Lobby& lobby, ExecutorType exec,
                                  std::vector<std::weak_ptr<Session>> sessions)
     : lobby_manager_(lobby_manager),
-      game_(lobby.players.size(), lobby.options.width, lobby.options.height),
+      game_(MakeLobbyGame(lobby)),
       id_(lobby.id),
       players_(lobby.players),
       player_to_idx_(lobby.players.size()),
@@ -54,12 +128,24 @@ boost::asio::awaitable<void> GameCoordinator::MakeMove(
 boost::asio::awaitable<void> GameCoordinator::MakeMoveImpl(
     const std::string& player_id, std::size_t cell_idx) {
   auto player_index = player_to_idx_.at(player_id);
-  if (player_index != game_.GetCurrentPlayer()) {
-    throw spread_logic::errors::kInvalidMove;
-  }
-  game_.MakeMove(cell_idx);
+  auto game_over = std::visit(
+      [&](auto& game) {
+        if (player_index != game.GetCurrentPlayer()) {
+          throw spread_logic::errors::kInvalidMove;
+        }
+        auto stats = game.MakeMove(cell_idx);
+        if (stats.cells_fired > kSlowMoveCells) {
+          spdlog::warn(
+              "Slow move in game {}: cell {} fired {} cells in {} waves, "
+              "peak {}, {} flips",
+              id_, cell_idx, stats.cells_fired, stats.waves,
+              stats.peak_queue, stats.owner_flips);
+        }
+        return game.GetAlivePlayers().size() <= 1;
+      },
+      game_);
   co_await BroadcastStateImpl();
-  if (game_.GetAlivePlayers().size() <= 1) {
+  if (game_over) {
     co_await EndGame();
   }
   co_return;
@@ -73,34 +159,57 @@ void GameCoordinator::EliminatePlayer(const std::string& player_id) {
 boost::asio::awaitable<void> GameCoordinator::EliminatePlayerImpl(
     const std::string& player_id) {
   auto player_index = player_to_idx_.at(player_id);
-  game_.EliminatePlayer(player_index);
+  auto game_over = std::visit(
+      [&](auto& game) {
+        game.EliminatePlayer(player_index);
+        return game.GetAlivePlayers().size() <= 1;
+      },
+      game_);
   co_await BroadcastStateImpl();
-  if (game_.GetAlivePlayers().size() <= 1) {
+  if (game_over) {
     co_await EndGame();
   }
   co_return;
 }
 
+boost::asio::awaitable<std::vector<std::uint8_t>>
+GameCoordinator::Checkpoint() {
+  return boost::asio::co_spawn(strand_, CheckpointImpl(),
+                               boost::asio::use_awaitable);
+}
+
+boost::asio::awaitable<std::vector<std::uint8_t>>
+GameCoordinator::CheckpointImpl() {
+  co_return std::visit(
+      [](const auto& game) { return spread_logic::EncodeGame(game); }, game_);
+}
+
 void GameCoordinator::BroadcastState() {
   boost::asio::co_spawn(strand_, BroadcastStateImpl(), boost::asio::detached);
 }
 
 boost::asio::awaitable<void> GameCoordinator::BroadcastStateImpl() {
-  std::vector<std::string_view> alive_players;
-  alive_players.reserve(players_.size());
-  for (auto idx : game_.GetAlivePlayers()) {
-    alive_players.emplace_back(players_[idx - 1]);
-  }
-  std::string_view current_player = players_[game_.GetCurrentPlayer() - 1];
-
-  SendToGame({
-      {"type", "game_state"},
-      {"field", game_.GetField()},
-      {"alive_players", std::move(alive_players)},
-      {"current_player", current_player},
-      {"turn", game_.GetCurrentTurn()},
-      {"move_history", game_.GetMoveHistory()},
-  });
+  auto state = std::visit(
+      [this](const auto& game) {
+        std::vector<std::string_view> alive_players;
+        alive_players.reserve(players_.size());
+        for (auto idx : game.GetAlivePlayers()) {
+          alive_players.emplace_back(players_[idx - 1]);
+        }
+        std::string_view current_player =
+            players_[game.GetCurrentPlayer() - 1];
+
+        return nlohmann::json{
+            {"type", "game_state"},
+            {"field", game.GetField()},
+            {"alive_players", std::move(alive_players)},
+            {"current_player", current_player},
+            {"turn", game.GetCurrentTurn()},
+            {"move_history", game.GetMoveHistory()},
+        };
+      },
+      game_);
+  SendToGame(std::move(state));
   co_return;
 }
 
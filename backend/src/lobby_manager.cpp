@@ -52,6 +52,31 @@ boost::asio::awaitable<std::string> LobbyManager::CreateLobbyImpl(
     spdlog::warn("{} already in a lobby", player_id);
     throw errors::kPlayerAlreadyInLobby;
   }
+  auto too_large = [this](std::int64_t width, std::int64_t height) {
+    return width < 1 || width > limits_.max_side || height < 1 ||
+           height > limits_.max_side || width * height > limits_.max_cells;
+  };
+  // A map holds at least one cell for every two characters, its rows ending
+  // in a line break
+  bool is_map = options.topology == "map";
+  if (is_map ? std::ssize(options.map) > 2 * limits_.max_cells
+             : too_large(options.width, options.height)) {
+    spdlog::warn("{} asked for a {}x{} board", player_id, options.width,
+                 options.height);
+    throw errors::kInvalidBoardSize;
+  }
+  // Bad shapes, maps and rule sets fail here rather than at the start
+  auto topology = GameCoordinator::MakeTopology(options);
+  GameCoordinator::MakeRules(options);
+  if (is_map) {
+    options.width = static_cast<int>(topology->GetWidth());
+    options.height = static_cast<int>(topology->GetHeight());
+    if (too_large(options.width, options.height)) {
+      spdlog::warn("{} asked for a {}x{} map", player_id, options.width,
+                   options.height);
+      throw errors::kInvalidBoardSize;
+    }
+  }
 
   std::ostringstream oss;
   oss << "l" << lobby_counter_++;
@@ -136,6 +161,7 @@ boost::asio::awaitable<void> LobbyManager::LeaveLobbyImpl(
     spdlog::info("Removed last player {}; deleting lobby {}", player_id,
                  lobby_id);
     lobbies_.erase(lit);
+    saved_games_.erase(lobby_id);
     SendToAll({{"type", "lobby_gone"}, {"lobby_id", lobby_id}});
     co_return;
   }
@@ -186,13 +212,14 @@ void LobbyManager::SendToLobby(const std::string& lobby_id,
 }
 
 boost::asio::awaitable<void> LobbyManager::StartGame(
-    const std::string& player_id) {
-  return boost::asio::co_spawn(strand_, StartGameImpl(player_id),
-                               boost::asio::use_awaitable);
+    const std::string& player_id, std::string checkpoint_id) {
+  return boost::asio::co_spawn(
+      strand_, StartGameImpl(player_id, std::move(checkpoint_id)),
+      boost::asio::use_awaitable);
 }
 
 boost::asio::awaitable<void> LobbyManager::StartGameImpl(
-    const std::string& player_id) {
+    const std::string& player_id, std::string checkpoint_id) {
   auto mit = membership_.find(player_id);
   if (mit == membership_.end()) {
     throw errors::kPlayerNotInLobby;
@@ -209,6 +236,16 @@ boost::asio::awaitable<void> LobbyManager::StartGameImpl(
   if (lobby.players.size() < 2) {
     throw errors::kNotEnoughPlayers;
   }
+  const SavedGame* saved = nullptr;
+  if (!checkpoint_id.empty()) {
+    auto sit = saved_games_.find(lobby_id);
+    if (sit == saved_games_.end() || sit->second.id != checkpoint_id) {
+      spdlog::warn("{} asked for unknown checkpoint {}", player_id,
+                   checkpoint_id);
+      throw errors::kCheckpointNotFound;
+    }
+    saved = &sit->second;
+  }
 
   std::vector<std::weak_ptr<Session>> sessions;
   sessions.reserve(lobby.players.size());
@@ -217,8 +254,16 @@ boost::asio::awaitable<void> LobbyManager::StartGameImpl(
       sessions.emplace_back(std::move(s));
     }
   }
-  auto game = GameCoordinator::Create(
-      *this, lobby, strand_.get_inner_executor(), std::move(sessions));
+  auto exec = strand_.get_inner_executor();
+  std::shared_ptr<GameCoordinator> game;
+  if (saved == nullptr) {
+    game = GameCoordinator::Create(*this, lobby, exec, std::move(sessions));
+  } else {
+    // Throws before anything changed if the players no longer fit it
+    game = GameCoordinator::Restore(*this, lobby, exec, std::move(sessions),
+                                    saved->checkpoint);
+    spdlog::info("Resumed game {} from checkpoint {}", lobby_id, saved->id);
+  }
   game->BroadcastState();
   games_[lobby_id] = std::move(game);
   lobby.status = models::LobbyStatus::InProgress;
@@ -226,6 +271,28 @@ boost::asio::awaitable<void> LobbyManager::StartGameImpl(
   co_return;
 }
 
+boost::asio::awaitable<std::string> LobbyManager::SaveGame(
+    const std::string& player_id, std::vector<std::uint8_t> checkpoint) {
+  return boost::asio::co_spawn(
+      strand_, SaveGameImpl(player_id, std::move(checkpoint)),
+      boost::asio::use_awaitable);
+}
+
+boost::asio::awaitable<std::string> LobbyManager::SaveGameImpl(
+    const std::string& player_id, std::vector<std::uint8_t> checkpoint) {
+  auto mit = membership_.find(player_id);
+  if (mit == membership_.end()) {
+    throw errors::kPlayerNotInLobby;
+  }
+  std::ostringstream oss;
+  oss << "c" << checkpoint_counter_++;
+  std::string checkpoint_id = oss.str();
+  spdlog::info("Saved game {} as checkpoint {} of {} bytes", mit->second,
+               checkpoint_id, checkpoint.size());
+  saved_games_[mit->second] = SavedGame{checkpoint_id, std::move(checkpoint)};
+  co_return checkpoint_id;
+}
+
 boost::asio::awaitable<void> LobbyManager::EndGame(
     const std::string& lobby_id) {
   return boost::asio::co_spawn(
@@ -32,9 +32,20 @@ int main(int argc, char* argv[]) {
     }
     spdlog::flush_on(spdlog::level::info);
 
+    // Board size limits of new lobbies
+    BoardLimits limits;
+    if (const char* side = std::getenv("MAX_BOARD_SIDE"); side != nullptr) {
+      limits.max_side = std::atoi(side);
+    }
+    if (const char* cells = std::getenv("MAX_BOARD_CELLS"); cells != nullptr) {
+      limits.max_cells = std::atoll(cells);
+    }
+
     spdlog::info("Starting Spread server on port {}", port);
+    spdlog::info("Boards up to {} per side and {} cells", limits.max_side,
+                 limits.max_cells);
     boost::asio::io_context ioc(std::thread::hardware_concurrency());
-    Server server(ioc, port);
+    Server server(ioc, port, limits);
     server.Start();
     ioc.run();
   } catch (const std::exception& ex) {
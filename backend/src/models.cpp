@@ -5,7 +5,11 @@ void to_json(nlohmann::json& j, const LobbyOptions& options) {
   j = nlohmann::json{{"name", options.name},
                      {"max_players", options.max_players},
                      {"width", options.width},
-                     {"height", options.height}};
+                     {"height", options.height},
+                     {"topology", options.topology},
+                     {"map", options.map},
+                     {"capture_enemies", options.capture_enemies},
+                     {"dots_per_move", options.dots_per_move}};
 }
 
 void to_json(nlohmann::json& j, const Lobby& lobby) {
@@ -28,6 +32,11 @@ void from_json(const nlohmann::json& j, LobbyOptions& options) {
   j.at("max_players").get_to(options.max_players);
   j.at("width").get_to(options.width);
   j.at("height").get_to(options.height);
+  // Lobbies saved before the rule variants play the classic game
+  options.topology = j.value("topology", options.topology);
+  options.map = j.value("map", options.map);
+  options.capture_enemies = j.value("capture_enemies", options.capture_enemies);
+  options.dots_per_move = j.value("dots_per_move", options.dots_per_move);
 }
 
 }  // namespace models
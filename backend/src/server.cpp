@@ -10,10 +10,11 @@
 
 using boost::asio::ip::tcp;
 
-Server::Server(boost::asio::io_context& ioc, unsigned short port)
+Server::Server(boost::asio::io_context& ioc, unsigned short port,
+               BoardLimits limits)
     : ioc_(ioc),
       acceptor_(ioc, tcp::endpoint(tcp::v4(), port)),
-      lobby_manager_(ioc) {
+      lobby_manager_(ioc, limits) {
 }
 
 void Server::Start() {
@@ -138,6 +138,8 @@ boost::asio::awaitable<void> Session::RouteMessage(nlohmann::json msg) {
       co_await HandleStartGame(msg);
     } else if (type == "make_move") {
       co_await HandleMakeMove(msg);
+    } else if (type == "save_game") {
+      co_await HandleSaveGame(msg);
     } else {
       spdlog::warn("{} sent unknown message type", player_id_);
       SendJson({{"type", "error"}, {"message", "Unknown message type"}});
@@ -167,8 +169,14 @@ boost::asio::awaitable<void> Session::HandleCreateLobby(
   int h = board.size() > 1 ? board[1] : 8;
   int maxp = msg.value("max_players", 4);
   std::string name = msg.at("name");
+  models::LobbyOptions options{name, maxp, w, h};
+  options.topology = msg.value("topology", options.topology);
+  options.map = msg.value("map", options.map);
+  options.capture_enemies =
+      msg.value("capture_enemies", options.capture_enemies);
+  options.dots_per_move = msg.value("dots_per_move", options.dots_per_move);
   auto lobby_id =
-      co_await lobby_manager_.CreateLobby(player_id_, {name, maxp, w, h});
+      co_await lobby_manager_.CreateLobby(player_id_, std::move(options));
   spdlog::info("{} created lobby {}", player_id_, lobby_id);
   SendJson({{"type", "joined"}, {"lobby_id", lobby_id}});
 }
@@ -191,7 +199,9 @@ boost::asio::awaitable<void> Session::HandleLeaveLobby(
 
 boost::asio::awaitable<void> Session::HandleStartGame(
     const nlohmann::json& msg) {
-  co_await lobby_manager_.StartGame(player_id_);
+  // The id of a game_saved message resumes that game instead of a new one
+  auto checkpoint_id = msg.value("checkpoint_id", std::string{});
+  co_await lobby_manager_.StartGame(player_id_, std::move(checkpoint_id));
   co_return;
 }
 
@@ -205,6 +215,20 @@ boost::asio::awaitable<void> Session::HandleMakeMove(
   std::size_t cell_idx = msg.at("cell_idx");
   co_await game->MakeMove(player_id_, cell_idx);
 }
+
+boost::asio::awaitable<void> Session::HandleSaveGame(
+    const nlohmann::json& msg) {
+  (void)msg;  // Unused
+  auto game = game_coordinator_.load();
+  if (!game) {
+    spdlog::warn("{} tried to save a game but is not in one", player_id_);
+    throw errors::kPlayerNotInGame;
+  }
+  auto checkpoint = co_await game->Checkpoint();
+  auto checkpoint_id =
+      co_await lobby_manager_.SaveGame(player_id_, std::move(checkpoint));
+  SendJson({{"type", "game_saved"}, {"checkpoint_id", checkpoint_id}});
+}
 const std::string& Session::PlayerId() const {
   return player_id_;
 }
@@ -0,0 +1,61 @@
+// Bots on boards with holes: every move they choose, and every move of their
+// own searches, must be one the game accepts.
+
+#include <cstdint>
+#include <memory>
+
+#include "alpha_beta_bot.hpp"
+#include "check.hpp"
+#include "mcts_bot.hpp"
+
+namespace {
+
+using spread_logic::Topology;
+
+// A map whose holes take a good share of the cells
+std::shared_ptr<const Topology> HoledMap() {
+  return Topology::FromMap(
+      "..#...#\n"
+      ".......\n"
+      "#.##.#.\n"
+      ".......\n"
+      "...#..#\n");
+}
+
+// Both players move by the bot until the game ends or the move limit
+template <class Bot>
+void CheckPlaysMap(Bot& bot, std::size_t players) {
+  spread_logic::Game game(players, HoledMap());
+  for (int turn = 0; turn < 120 && game.GetAlivePlayers().size() > 1; ++turn) {
+    auto cell = bot.ChooseMove(game);
+    CHECK(game.GetLegalMoves().Contains(cell));
+    CHECK(!game.GetField().GetTopology()->IsBlocked(cell));
+    game.MakeMove(cell);
+  }
+}
+
+void CheckBots() {
+  for (std::uint64_t seed = 1; seed <= 3; ++seed) {
+    spread_ai::MctsOptions options;
+    options.time_budget = std::chrono::milliseconds(0);
+    options.playout_budget = 200;
+    options.thread_count = 2;
+    options.seed = seed;
+    spread_ai::MctsBot mcts(options);
+    CheckPlaysMap(mcts, 1 + seed);
+  }
+
+  spread_ai::AlphaBetaOptions options;
+  options.time_budget = std::chrono::milliseconds(0);
+  options.max_depth = 2;
+  options.table_size_mb = 1;
+  spread_ai::AlphaBetaBot alpha_beta(options);
+  CheckPlaysMap(alpha_beta, 2);
+}
+
+}  // namespace
+
+int main() {
+  CheckBots();
+  return spread_tests::TestResult();
+}
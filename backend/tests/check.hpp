@@ -0,0 +1,32 @@
+#pragma once
+
+// Checks of the test executables. A failed CHECK prints the expression and
+// the test goes on; main returns TestResult().
+
+#include <cstdio>
+
+namespace spread_tests {
+
+inline int& FailedChecks() {
+  static int failed = 0;
+  return failed;
+}
+
+inline int TestResult() {
+  if (FailedChecks() != 0) {
+    std::fprintf(stderr, "%d checks failed\n", FailedChecks());
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace spread_tests
+
+#define CHECK(condition)                                          \
+  do {                                                            \
+    if (!(condition)) {                                           \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, \
+                   __LINE__, #condition);                         \
+      ++spread_tests::FailedChecks();                             \
+    }                                                             \
+  } while (false)
@@ -0,0 +1,339 @@
+// Packed field and checkpoint encodings: positions of random games survive
+// encode, decode, encode byte for byte, checkpoints bring back their board
+// and rules, and malformed or mismatching data is rejected.
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "check.hpp"
+#include "game_codec.hpp"
+#include "replay.hpp"
+
+namespace {
+
+using spread_logic::Topology;
+
+// True if the call throws the given error
+template <class Call>
+bool Throws(const std::logic_error& error, Call&& call) {
+  try {
+    call();
+  } catch (const std::logic_error& e) {
+    return std::string_view(e.what()) == error.what();
+  }
+  return false;
+}
+
+template <class FieldType>
+bool HasOverfullCells(const FieldType& field) {
+  for (std::size_t index = 0; index < field.GetCellCount(); ++index) {
+    if (field.GetFullness(index) != 0 &&
+        field.GetFullness(index) >= field.GetCapacity(index)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <class GameType>
+std::optional<std::size_t> RandomLegalMove(const GameType& game,
+                                           std::mt19937_64& rng) {
+  auto legal = game.GetLegalMoves();
+  std::vector<std::size_t> moves;
+  for (std::size_t cell = 0; cell < game.GetField().GetCellCount(); ++cell) {
+    if (legal.Contains(cell)) {
+      moves.push_back(cell);
+    }
+  }
+  if (moves.empty()) {
+    return std::nullopt;
+  }
+  return moves[rng() % moves.size()];
+}
+
+// Encode the field both ways and decode into a field of the same shape
+template <class FieldType>
+void CheckFieldRoundTrip(const FieldType& field, FieldType blank,
+                         bool allow_overfull) {
+  for (bool run_length : {false, true}) {
+    auto data = spread_logic::EncodeField(field, run_length);
+    auto decoded = blank;
+    spread_logic::DecodeField(data, decoded, allow_overfull);
+    CHECK(spread_logic::EncodeField(decoded, run_length) == data);
+    CHECK(decoded.StateHash() == field.StateHash());
+    CHECK(std::equal(decoded.GetPlayerScores().begin(),
+                     decoded.GetPlayerScores().end(),
+                     field.GetPlayerScores().begin()));
+  }
+}
+
+// Random games from make_game(), with the field and the checkpoint of every
+// position round-tripped. Returns the number of finished games left with
+// overfull cells, which only checkpoints accept.
+template <class MakeGame>
+std::size_t CheckRoundTrips(MakeGame&& make_game, std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::size_t overfull_endings = 0;
+  for (int round = 0; round < 50; ++round) {
+    auto game = make_game(rng);
+    auto blank = game;
+    for (int turn = 0; turn < 300; ++turn) {
+      const auto& field = game.GetField();
+      bool over = game.GetAlivePlayers().size() <= 1;
+      CheckFieldRoundTrip(field, blank.GetField(), over);
+
+      auto data = spread_logic::EncodeGame(game);
+      auto restored = blank;
+      spread_logic::DecodeGame(data, restored);
+      CHECK(spread_logic::EncodeGame(restored) == data);
+      if (over) {
+        overfull_endings += HasOverfullCells(field) ? 1 : 0;
+        break;
+      }
+
+      auto move = RandomLegalMove(game, rng);
+      if (!move) {
+        break;
+      }
+      game.MakeMove(*move);
+    }
+  }
+  return overfull_endings;
+}
+
+std::uint32_t RandomSide(std::mt19937_64& rng) {
+  return static_cast<std::uint32_t>(3 + rng() % 6);
+}
+
+void CheckRoundTrips() {
+  auto overfull_endings = CheckRoundTrips(
+      [](std::mt19937_64& rng) {
+        return spread_logic::Game(2 + rng() % 3, RandomSide(rng),
+                                  RandomSide(rng));
+      },
+      1);
+  overfull_endings += CheckRoundTrips(
+      [](std::mt19937_64& rng) {
+        return spread_logic::FixedGame<8, 8>(2 + rng() % 3, 8, 8);
+      },
+      2);
+  overfull_endings += CheckRoundTrips(
+      [](std::mt19937_64& rng) {
+        return spread_logic::VariantGame<true, 2>(2 + rng() % 3,
+                                                  RandomSide(rng),
+                                                  RandomSide(rng));
+      },
+      3);
+  CheckRoundTrips(
+      [](std::mt19937_64& rng) {
+        return spread_logic::VariantGame<false, 2>(2 + rng() % 3,
+                                                   RandomSide(rng),
+                                                   RandomSide(rng));
+      },
+      4);
+  overfull_endings += CheckRoundTrips(
+      [](std::mt19937_64& rng) {
+        auto width = RandomSide(rng);
+        auto height = RandomSide(rng);
+        std::shared_ptr<const Topology> topologies[] = {
+            Topology::Torus(width, height), Topology::Hex(width, height),
+            Topology::Moore(width, height),
+            Topology::FromMap("..#..\n.....\n#...#\n.....\n..#..")};
+        return spread_logic::Game(2 + rng() % 3, topologies[rng() % 4]);
+      },
+      5);
+  // Games that end mid-cascade leave overfull cells behind
+  CHECK(overfull_endings > 0);
+
+  // The standalone decode of a rectangle
+  spread_logic::Game game(3, 7, 5);
+  for (std::size_t move = 0; move < 40; ++move) {
+    if (game.GetLegalMoves().Contains(move % 35)) {
+      game.MakeMove(move % 35);
+    }
+  }
+  for (bool run_length : {false, true}) {
+    auto data = spread_logic::EncodeField(game.GetField(), run_length);
+    CHECK(spread_logic::EncodeField(spread_logic::DecodeField(data),
+                                    run_length) == data);
+  }
+}
+
+void WriteVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+  for (; value >= 0x80; value >>= 7) {
+    out.push_back(static_cast<std::uint8_t>(value | 0x80));
+  }
+  out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Empty two-player game on a 20000x20000 board of the kind, 28 bytes
+std::vector<std::uint8_t> HugeCheckpoint(spread_logic::TopologyKind kind) {
+  std::vector<std::uint8_t> field = {spread_logic::kFieldEncodingVersion, 1};
+  WriteVarint(field, 20000);
+  WriteVarint(field, 20000);
+  field.insert(field.end(), {2, 0, 0, 0xF1});
+  WriteVarint(field, std::uint64_t{20000} * 20000);
+
+  std::vector<std::uint8_t> data = {spread_logic::kGameEncodingVersion};
+  WriteVarint(data, field.size());
+  data.insert(data.end(), field.begin(), field.end());
+  data.insert(data.end(), {1, 1, static_cast<std::uint8_t>(kind)});
+  data.insert(data.end(), {3, 1, 0, 0, 0, 0});
+  return data;
+}
+
+// Checkpoints bring back their board and rules, and decode only into a game
+// with the same
+void CheckCheckpointBoards() {
+  using spread_logic::RuleOptions;
+  std::mt19937_64 rng(6);
+  auto map = Topology::FromMap("..#.\n....\n.#..\n");
+  auto triangle =
+      Topology::FromNeighbors(3, 1, {0, 2, 4, 6}, {1, 2, 0, 2, 0, 1});
+  std::pair<std::shared_ptr<const Topology>, RuleOptions> boards[] = {
+      {map, {true, 1}},
+      {triangle, {true, 1}},
+      {Topology::Hex(5, 4), {false, 2}},
+      {Topology::Rectangle(8, 8), {true, 1}}};
+  for (const auto& [topology, rules] : boards) {
+    auto game = spread_logic::MakeGame(3, topology, rules);
+    std::visit(
+        [&](auto& typed) {
+          for (int turn = 0; turn < 6 && typed.GetAlivePlayers().size() > 1;
+               ++turn) {
+            if (auto move = RandomLegalMove(typed, rng)) {
+              typed.MakeMove(*move);
+            }
+          }
+          auto data = spread_logic::EncodeGame(typed);
+          auto header = spread_logic::ReadGameHeader(data);
+          CHECK(header.rules == rules &&
+                header.topology_kind == topology->GetKind());
+
+          auto restored = spread_logic::DecodeGame(data);
+          using GameType = std::decay_t<decltype(typed)>;
+          CHECK(std::holds_alternative<GameType>(restored));
+          if (const auto* same = std::get_if<GameType>(&restored)) {
+            CHECK(*same->GetField().GetTopology() == *topology);
+            CHECK(spread_logic::EncodeGame(*same) == data);
+          }
+          CHECK(spread_logic::ReplayCheckpoint(data).verified);
+        },
+        game);
+  }
+
+  const auto& mismatch = spread_logic::errors::kCheckpointMismatch;
+  auto torus = spread_logic::EncodeGame(
+      spread_logic::Game(3, Topology::Torus(5, 4)));
+  spread_logic::Game rectangle(3, 5, 4);
+  CHECK(Throws(mismatch, [&] { spread_logic::DecodeGame(torus, rectangle); }));
+  spread_logic::Game two_players(2, Topology::Torus(5, 4));
+  CHECK(Throws(mismatch,
+               [&] { spread_logic::DecodeGame(torus, two_players); }));
+  spread_logic::VariantGame<false, 1> no_capture(3, Topology::Torus(5, 4));
+  CHECK(Throws(mismatch,
+               [&] { spread_logic::DecodeGame(torus, no_capture); }));
+  auto holes = spread_logic::EncodeGame(spread_logic::Game(3, map));
+  spread_logic::Game other_holes(3, Topology::FromMap("..#.\n....\n..#.\n"));
+  CHECK(Throws(mismatch,
+               [&] { spread_logic::DecodeGame(holes, other_holes); }));
+  spread_logic::Game same_holes(3, Topology::FromMap("..#.\n....\n.#..\n"));
+  spread_logic::DecodeGame(holes, same_holes);
+
+  // A few bytes naming a huge board are compared before it is built
+  for (auto kind : {Topology::Rectangle(8, 8), Topology::Moore(8, 8)}) {
+    auto huge = HugeCheckpoint(kind->GetKind());
+    CHECK(spread_logic::ReadGameHeader(huge).field.width == 20000);
+    spread_logic::Game small(2, kind);
+    CHECK(Throws(mismatch, [&] { spread_logic::DecodeGame(huge, small); }));
+  }
+
+  // A board the factories reject is bad checkpoint data, here a 2x1 torus
+  auto narrow = spread_logic::EncodeGame(spread_logic::Game(2, 2, 1));
+  narrow[2 + narrow[1] + 2] =
+      static_cast<std::uint8_t>(spread_logic::TopologyKind::kTorus);
+  CHECK(Throws(spread_logic::errors::kInvalidGameEncoding,
+               [&] { spread_logic::DecodeGame(narrow); }));
+
+  // Version 1 had neither rules nor topology
+  auto old = holes;
+  old[0] = 1;
+  CHECK(Throws(spread_logic::errors::kInvalidGameEncoding,
+               [&] { spread_logic::DecodeGame(old); }));
+}
+
+// Header and cells of a hand-written encoding, sizes below 128
+std::vector<std::uint8_t> Encoding(bool run_length, std::uint8_t width,
+                                   std::uint8_t height,
+                                   std::vector<std::uint8_t> cells) {
+  std::vector<std::uint8_t> data = {spread_logic::kFieldEncodingVersion,
+                                    static_cast<std::uint8_t>(run_length),
+                                    width, height, 2, 0, 0};
+  data.insert(data.end(), cells.begin(), cells.end());
+  return data;
+}
+
+void CheckRejections() {
+  const auto& invalid = spread_logic::errors::kInvalidFieldEncoding;
+
+  // A valid 2x2 board: one dot of player 1, one of player 2
+  auto valid = Encoding(false, 2, 2, {0x11, 0x00, 0x00, 0x21});
+  spread_logic::Field field(2, 2, 2);
+  spread_logic::DecodeField(valid, field);
+  CHECK(field.GetOwner(0) == 1 && field.GetOwner(3) == 2);
+
+  for (std::size_t size = 0; size < valid.size(); ++size) {
+    std::span<const std::uint8_t> truncated(valid.data(), size);
+    CHECK(Throws(invalid, [&] { spread_logic::DecodeField(truncated); }));
+  }
+  auto trailing = valid;
+  trailing.push_back(0);
+  CHECK(Throws(invalid, [&] { spread_logic::DecodeField(trailing); }));
+  CHECK(Throws(invalid, [&] {
+    spread_logic::DecodeField(Encoding(true, 2, 2, {0xF1, 5}));
+  }));
+  CHECK(Throws(invalid, [&] {
+    spread_logic::DecodeField(Encoding(false, 2, 2, {0x31, 0, 0, 0}));
+  }));
+
+  // A board of 100 million cells claimed by a few bytes is rejected before
+  // anything is allocated
+  std::vector<std::uint8_t> huge = {spread_logic::kFieldEncodingVersion,
+                                    0, 0x90, 0x4E, 0x90, 0x4E, 2, 0, 0, 0x11};
+  CHECK(spread_logic::ReadFieldHeader(Encoding(false, 2, 2, {0, 0, 0, 0}))
+            .width == 2);
+  CHECK(Throws(invalid, [&] { spread_logic::ReadFieldHeader(huge); }));
+  CHECK(Throws(invalid, [&] { spread_logic::DecodeField(huge); }));
+
+  // A corner holds at most one dot at rest
+  auto overfull = Encoding(false, 2, 2, {0x12, 0x00, 0x00, 0x21});
+  CHECK(Throws(invalid, [&] { spread_logic::DecodeField(overfull); }));
+  spread_logic::DecodeField(overfull, field, true);
+  CHECK(field.GetFullness(0) == 2);
+
+  // Blocked cells never hold dots, cell 1 is one
+  spread_logic::Field map(2, Topology::FromMap(".#\n.."));
+  auto blocked = Encoding(false, 2, 2, {0x00, 0x11, 0x21, 0x00});
+  CHECK(Throws(invalid, [&] { spread_logic::DecodeField(blocked, map); }));
+  CHECK(Throws(invalid,
+               [&] { spread_logic::DecodeField(blocked, map, true); }));
+  spread_logic::DecodeField(Encoding(false, 2, 2, {0x00, 0x00, 0x21, 0x00}),
+                            map);
+  CHECK(map.GetOwner(2) == 2);
+}
+
+}  // namespace
+
+int main() {
+  CheckRoundTrips();
+  CheckCheckpointBoards();
+  CheckRejections();
+  return spread_tests::TestResult();
+}
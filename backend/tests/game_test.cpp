@@ -0,0 +1,131 @@
+// Game rules that shortcut or bound the chain reaction and the statistics of
+// each move, checked against the cascade played out on a bare field.
+
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+#include "game.hpp"
+
+namespace {
+
+using spread_logic::PlayerSet;
+
+// Waves the reference runs before calling a cascade endless, far above the
+// cap of the game on the boards below
+constexpr std::size_t kReferenceWaves = 1 << 16;
+
+// A cascade can only come to rest if every cell holds less than its
+// capacity, so a board with more than sum(capacity - 1) dots never settles
+template <class FieldType>
+bool CanSettle(const FieldType& field) {
+  std::uint64_t dots = 0;
+  std::uint64_t limit = 0;
+  for (std::size_t index = 0; index < field.GetCellCount(); ++index) {
+    dots += field.GetFullness(index);
+    if (field.GetCapacity(index) != 0) {
+      limit += field.GetCapacity(index) - 1U;
+    }
+  }
+  return dots <= limit;
+}
+
+// Owner of every cell the alive players still hold once the cascade of the
+// move is played out with no cap, 0 if several keep cells or it never ends
+template <class FieldType>
+std::size_t PlayOutWinner(FieldType field, PlayerSet alive, std::size_t mover,
+                          std::size_t cell) {
+  field.PlaceDot(mover, cell);
+  for (std::size_t wave = 0; wave < kReferenceWaves; ++wave) {
+    std::size_t owners = 0;
+    std::size_t owner = 0;
+    for (auto player : alive) {
+      if (field.GetOwnedCells()[player] > 0) {
+        ++owners;
+        owner = player;
+      }
+    }
+    if (owners == 1) {
+      return owner;
+    }
+    if (field.SpreadStep() == 0) {
+      return 0;
+    }
+  }
+  return 0;
+}
+
+// Random games on small boards, where endless cascades are common: every move
+// that ends the game must crown the player the full cascade leaves alone
+template <class GameType>
+void CheckGameEndings(std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::size_t endings = 0;
+  std::size_t unsettled_endings = 0;
+  for (int round = 0; round < 4000; ++round) {
+    auto players = 2 + rng() % 3;
+    auto width = static_cast<std::uint32_t>(2 + rng() % 5);
+    auto height = static_cast<std::uint32_t>(2 + rng() % 5);
+    GameType game(players, width, height);
+    // Games without capture may never end
+    for (int turn = 0; turn < 200 && game.GetAlivePlayers().size() > 1;
+         ++turn) {
+      auto legal = game.GetLegalMoves();
+      std::vector<std::size_t> moves;
+      for (std::size_t cell = 0; cell < game.GetField().GetCellCount();
+           ++cell) {
+        if (legal.Contains(cell)) {
+          moves.push_back(cell);
+        }
+      }
+      if (moves.empty()) {
+        // A player whose last cell went in the first round stays alive until
+        // a wave runs; with two dots per move the board may fill up first
+        break;
+      }
+      auto cell = moves[rng() % moves.size()];
+      auto mover = game.GetCurrentPlayer();
+      auto alive = game.GetAlivePlayers();
+      auto before = game.GetField();
+      auto stats = game.MakeMove(cell);
+      if constexpr (spread_logic::kMoveStatsEnabled) {
+        // Replaying the counted waves must give the position of the game
+        auto replay = before;
+        replay.PlaceDot(mover, cell);
+        std::uint64_t fired = 0;
+        for (std::uint32_t wave = 0; wave < stats.waves; ++wave) {
+          fired += replay.SpreadStep();
+        }
+        CHECK(stats.waves == game.GetLastCascadeWaves());
+        CHECK(stats.cells_fired == fired);
+        CHECK(replay.StateHash() == game.GetField().StateHash());
+      }
+      if (game.GetAlivePlayers().size() > 1) {
+        continue;
+      }
+
+      ++endings;
+      auto placed = before;
+      placed.PlaceDot(mover, cell);
+      if (!CanSettle(placed)) {
+        ++unsettled_endings;
+      }
+      auto winner = PlayOutWinner(before, alive, mover, cell);
+      if (winner != 0) {
+        CHECK(game.GetAlivePlayers().front() == winner);
+      }
+    }
+  }
+  // The boards must reach the dot counts that can never settle
+  CHECK(endings > 0);
+  CHECK(unsettled_endings > 0);
+}
+
+}  // namespace
+
+int main() {
+  CheckGameEndings<spread_logic::Game>(1);
+  CheckGameEndings<spread_logic::VariantGame<true, 2>>(2);
+  CheckGameEndings<spread_logic::VariantGame<false, 1>>(3);
+  return spread_tests::TestResult();
+}
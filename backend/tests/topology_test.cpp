@@ -0,0 +1,211 @@
+// Neighbor lists and capacities of the board generators, checked against the
+// geometry of each kind computed pair by pair, plus a few cells by hand.
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "topology.hpp"
+
+namespace {
+
+using spread_logic::Topology;
+
+std::vector<std::uint32_t> Neighbors(const Topology& topology,
+                                     std::size_t index) {
+  auto offsets = topology.GetNeighborOffsets();
+  auto neighbors = topology.GetNeighbors();
+  std::vector<std::uint32_t> list(neighbors + offsets[index],
+                                  neighbors + offsets[index + 1]);
+  std::sort(list.begin(), list.end());
+  return list;
+}
+
+// Compare every list with the cells the predicate calls adjacent, and the
+// capacities with the degrees
+template <class Adjacent>
+void CheckGraph(const Topology& topology, Adjacent&& adjacent) {
+  auto width = topology.GetWidth();
+  auto cell_count = topology.GetCellCount();
+  CHECK(cell_count == std::size_t{width} * topology.GetHeight());
+  CHECK(topology.GetNeighborOffsets() != nullptr);
+  for (std::size_t index = 0; index < cell_count; ++index) {
+    std::vector<std::uint32_t> expected;
+    for (std::size_t other = 0; other < cell_count; ++other) {
+      if (other != index && adjacent(index % width, index / width,
+                                     other % width, other / width)) {
+        expected.push_back(static_cast<std::uint32_t>(other));
+      }
+    }
+    CHECK(Neighbors(topology, index) == expected);
+    CHECK(topology.GetCapacity()[index] == expected.size());
+    CHECK(topology.IsBlocked(index) == expected.empty());
+  }
+}
+
+std::int64_t Distance(std::size_t a, std::size_t b) {
+  return std::abs(static_cast<std::int64_t>(a) - static_cast<std::int64_t>(b));
+}
+
+// Distance on a ring of the given length
+std::int64_t RingDistance(std::size_t a, std::size_t b, std::size_t length) {
+  auto d = Distance(a, b);
+  return std::min<std::int64_t>(d, static_cast<std::int64_t>(length) - d);
+}
+
+// Cube coordinates of a hex cell, odd rows shifted right
+struct Cube {
+  std::int64_t q;
+  std::int64_t r;
+};
+
+Cube ToCube(std::size_t x, std::size_t y) {
+  auto row = static_cast<std::int64_t>(y);
+  return Cube{static_cast<std::int64_t>(x) - (row - (row & 1)) / 2, row};
+}
+
+bool HexAdjacent(std::size_t x, std::size_t y, std::size_t ox,
+                 std::size_t oy) {
+  auto a = ToCube(x, y);
+  auto b = ToCube(ox, oy);
+  auto dq = a.q - b.q;
+  auto dr = a.r - b.r;
+  return (std::abs(dq) + std::abs(dr) + std::abs(dq + dr)) == 2;
+}
+
+void CheckGenerators() {
+  for (std::uint32_t width = 1; width <= 7; ++width) {
+    for (std::uint32_t height = 1; height <= 7; ++height) {
+      if (width * height < 2) {
+        continue;
+      }
+      CheckGraph(*Topology::Rectangle(width, height),
+                 [](auto x, auto y, auto ox, auto oy) {
+                   return Distance(x, ox) + Distance(y, oy) == 1;
+                 });
+      CheckGraph(*Topology::Hex(width, height), HexAdjacent);
+      CheckGraph(*Topology::Moore(width, height),
+                 [](auto x, auto y, auto ox, auto oy) {
+                   return std::max(Distance(x, ox), Distance(y, oy)) == 1;
+                 });
+      if (width >= 3 && height >= 3) {
+        CheckGraph(*Topology::Torus(width, height),
+                   [width, height](auto x, auto y, auto ox, auto oy) {
+                     return RingDistance(x, ox, width) +
+                                RingDistance(y, oy, height) ==
+                            1;
+                   });
+      }
+    }
+  }
+
+  const std::string map =
+      "..#..\n"
+      ".....\n"
+      "#.#.#\n"
+      "..#..\n";
+  auto is_cell = [&map](std::size_t x, std::size_t y) {
+    return map[y * 6 + x] == '.';
+  };
+  CheckGraph(*Topology::FromMap(map),
+             [&is_cell](auto x, auto y, auto ox, auto oy) {
+               return is_cell(x, y) && is_cell(ox, oy) &&
+                      Distance(x, ox) + Distance(y, oy) == 1;
+             });
+}
+
+// A few cells spelled out, independent of the geometry above
+void CheckKnownCells() {
+  using List = std::vector<std::uint32_t>;
+  auto rectangle = Topology::Rectangle(4, 3);
+  CHECK(Neighbors(*rectangle, 0) == (List{1, 4}));
+  CHECK(Neighbors(*rectangle, 1) == (List{0, 2, 5}));
+  CHECK(Neighbors(*rectangle, 5) == (List{1, 4, 6, 9}));
+
+  auto torus = Topology::Torus(3, 3);
+  CHECK(Neighbors(*torus, 0) == (List{1, 2, 3, 6}));
+  CHECK(Neighbors(*torus, 8) == (List{2, 5, 6, 7}));
+
+  // Row 1 sits half a cell to the right of rows 0 and 2
+  auto hex = Topology::Hex(4, 3);
+  CHECK(Neighbors(*hex, 5) == (List{1, 2, 4, 6, 9, 10}));
+  CHECK(Neighbors(*hex, 9) == (List{4, 5, 8, 10}));
+  CHECK(Neighbors(*hex, 0) == (List{1, 4}));
+  CHECK(hex->GetCapacity()[7] == 3);
+
+  auto moore = Topology::Moore(3, 3);
+  CHECK(Neighbors(*moore, 4) == (List{0, 1, 2, 3, 5, 6, 7, 8}));
+  CHECK(Neighbors(*moore, 0) == (List{1, 3, 4}));
+
+  auto map = Topology::FromMap(".#\n..\n");
+  CHECK(map->IsBlocked(1) && map->GetBlocked() != nullptr);
+  CHECK(Neighbors(*map, 0) == (List{2}));
+  CHECK(Neighbors(*map, 2) == (List{0, 3}));
+
+  // Large rectangles leave the neighbors to the Sides bits
+  auto side = static_cast<std::uint32_t>(1 << 9);
+  auto large = Topology::Rectangle(side, side);
+  CHECK(large->GetNeighborOffsets() == nullptr);
+  CHECK(large->GetCapacity()[0] == 2 && large->GetCapacity()[1] == 3 &&
+        large->GetCapacity()[side + 1] == 4);
+}
+
+void CheckInvalid() {
+  auto rejects = [](auto&& build) {
+    try {
+      build();
+    } catch (const std::logic_error& e) {
+      return std::string_view(e.what()) ==
+             spread_logic::errors::kInvalidTopology.what();
+    }
+    return false;
+  };
+  CHECK(rejects([] { Topology::Rectangle(1, 1); }));
+  CHECK(rejects([] { Topology::Torus(2, 5); }));
+  CHECK(rejects([] { Topology::FromMap(""); }));
+  CHECK(rejects([] { Topology::FromMap("..\n...\n"); }));
+  CHECK(rejects([] { Topology::FromMap("..\n.x\n"); }));
+  CHECK(rejects([] { Topology::FromMap(".#.\n###\n..#\n"); }));
+  CHECK(rejects([] { Topology::FromMap(".#\n#.\n"); }));
+  CHECK(rejects([] { Topology::FromNeighbors(2, 1, {0, 1, 2}, {1, 1}); }));
+  // A ring one way round: every cell feeds a cell that never feeds it back
+  CHECK(rejects(
+      [] { Topology::FromNeighbors(3, 1, {0, 1, 2, 3}, {1, 2, 0}); }));
+  // Listed twice from one end only
+  CHECK(rejects([] {
+    Topology::FromNeighbors(3, 1, {0, 3, 4, 5}, {1, 1, 2, 0, 0});
+  }));
+
+  // A star whose center touches every other cell, up to kMaxDegree of them
+  auto star = [](std::uint32_t leaves) {
+    std::vector<std::uint32_t> offsets = {0, leaves};
+    std::vector<std::uint32_t> neighbors;
+    for (std::uint32_t leaf = 1; leaf <= leaves; ++leaf) {
+      neighbors.push_back(leaf);
+    }
+    for (std::uint32_t leaf = 1; leaf <= leaves; ++leaf) {
+      neighbors.push_back(0);
+      offsets.push_back(offsets.back() + 1);
+    }
+    return Topology::FromNeighbors(leaves + 1, 1, std::move(offsets),
+                                   std::move(neighbors));
+  };
+  auto widest = star(Topology::kMaxDegree);
+  CHECK(widest->GetCapacity()[0] == Topology::kMaxDegree);
+  CHECK(rejects([&star] { star(Topology::kMaxDegree + 1); }));
+}
+
+}  // namespace
+
+int main() {
+  CheckGenerators();
+  CheckKnownCells();
+  CheckInvalid();
+  return spread_tests::TestResult();
+}